@@ -0,0 +1,82 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Oarena.h"
+#include <fftw3.h>
+#include <cstdlib>
+#include <sys/mman.h>
+
+////////////////////////////////////////////////////////////////////////////////////
+Oarena::Oarena(const int aNbuffers, const bool aHugePages){
+////////////////////////////////////////////////////////////////////////////////////
+  nbuffers  = aNbuffers>0?aNbuffers:1;
+  hugepages = aHugePages;
+  buffer    = new double* [nbuffers];
+  capacity  = new long int [nbuffers];
+  huge      = new bool [nbuffers];
+  for(int b=0; b<nbuffers; b++){
+    buffer[b]=NULL;
+    capacity[b]=0;
+    huge[b]=false;
+  }
+  nalloc=0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Oarena::~Oarena(void){
+////////////////////////////////////////////////////////////////////////////////////
+  for(int b=0; b<nbuffers; b++) Free(b);
+  delete [] buffer;
+  delete [] capacity;
+  delete [] huge;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+double* Oarena::Get(const int aIndex, const long int aSize){
+////////////////////////////////////////////////////////////////////////////////////
+  if(aIndex<0||aIndex>=nbuffers){
+    cerr<<"Oarena::Get: the buffer index "<<aIndex<<" is out of range"<<endl;
+    return NULL;
+  }
+  if(aSize<=capacity[aIndex]) return buffer[aIndex];
+  Free(aIndex);
+
+  size_t bytes=(size_t)aSize*sizeof(double);
+  void *ptr=NULL;
+
+  // large buffer: huge-page alignment (the size is rounded to a number of huge pages)
+  if(hugepages&&bytes>=OARENA_HUGEPAGE){
+    bytes=(bytes+OARENA_HUGEPAGE-1)/OARENA_HUGEPAGE*OARENA_HUGEPAGE;
+    if(posix_memalign(&ptr, OARENA_HUGEPAGE, bytes)) ptr=NULL;
+    else{
+#ifdef MADV_HUGEPAGE
+      madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+      huge[aIndex]=true;
+    }
+  }
+
+  // aligned for vector instructions
+  if(ptr==NULL) ptr=fftw_malloc(bytes);
+  if(ptr==NULL){
+    cerr<<"Oarena::Get: cannot allocate "<<bytes<<" bytes"<<endl;
+    return NULL;
+  }
+
+  buffer[aIndex]=(double*)ptr;
+  capacity[aIndex]=(long int)(bytes/sizeof(double));
+  nalloc++;
+  return buffer[aIndex];
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Oarena::Free(const int aIndex){
+////////////////////////////////////////////////////////////////////////////////////
+  if(buffer[aIndex]==NULL) return;
+  if(huge[aIndex]) free(buffer[aIndex]);
+  else fftw_free(buffer[aIndex]);
+  buffer[aIndex]=NULL;
+  capacity[aIndex]=0;
+  huge[aIndex]=false;
+  return;
+}
@@ -0,0 +1,64 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#ifndef __Oarena__
+#define __Oarena__
+
+#include <iostream>
+
+using namespace std;
+
+// large buffers: huge-page size [bytes]
+#define OARENA_HUGEPAGE 2097152
+
+/**
+ * Aligned data buffers re-used across chunks and channels.
+ * This class was designed to hold the large data vectors of the Omicron class. A buffer is identified by an index. It is allocated with the FFTW allocator (aligned for vector instructions) the first time it is requested. It is only re-allocated if a larger size is requested: after the first chunk, the buffers are not allocated anymore.
+ *
+ * Optionally, the buffers larger than a huge page (2 MB) are aligned on a huge-page boundary and the kernel is advised to back them with transparent huge pages (Linux only). This reduces the TLB misses when long data vectors are processed.
+ * \author    Florent Robinet
+ */
+class Oarena {
+
+ public:
+
+  /**
+   * Constructor of the Oarena class.
+   * No buffer is allocated.
+   * @param aNbuffers number of buffers
+   * @param aHugePages set to true to use huge pages for the large buffers
+   */
+  Oarena(const int aNbuffers, const bool aHugePages=false);
+
+  /**
+   * Destructor of the Oarena class.
+   * All the buffers are released.
+   */
+  virtual ~Oarena(void);
+
+  /**
+   * Returns a buffer with at least a given number of samples.
+   * If the buffer is too small, it is re-allocated: the content is lost.
+   * @param aIndex buffer index
+   * @param aSize number of samples
+   */
+  double* Get(const int aIndex, const long int aSize);
+
+  /**
+   * Returns the number of buffer allocations since the object was created.
+   */
+  inline long int GetNAllocations(void){ return nalloc; };
+
+ private:
+
+  int nbuffers;                 ///< number of buffers
+  bool hugepages;               ///< use huge pages for large buffers
+  double **buffer;              ///< buffers
+  long int *capacity;           ///< buffer capacity (number of samples)
+  bool *huge;                   ///< the buffer is aligned on a huge page
+  long int nalloc;              ///< number of allocations
+
+  void Free(const int aIndex);  ///< release a buffer
+};
+
+#endif
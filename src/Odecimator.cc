@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Odecimator.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+Odecimator::Odecimator(const int aNativeFrequency, const int aWorkingFrequency){
+////////////////////////////////////////////////////////////////////////////////////
+
+  native=aNativeFrequency;
+  working=aWorkingFrequency;
+  status_OK=true;
+  if(native<=0||working<=0||native%working){
+    cerr<<"Odecimator::Odecimator: the native frequency ("<<native<<" Hz) must be a multiple of the working frequency ("<<working<<" Hz)"<<endl;
+    status_OK=false;
+    working=native;
+  }
+  M=native/working;
+
+  // Kaiser design: 80 dB attenuation in the stopband, starting at the working Nyquist frequency
+  // the passband extends to 90% of the working Nyquist frequency
+  double fp = 0.9/(double)M/2.0; // passband edge (fraction of the native frequency)
+  double fs = 1.0/(double)M/2.0; // stopband edge (fraction of the native frequency)
+  double att = 80.0;             // stopband attenuation [dB]
+  double beta = 0.1102*(att-8.7);
+  L=(int)ceil((att-7.95)/(2.285*2.0*TMath::Pi()*(fs-fp))/2.0);
+  if(M==1) L=0;
+  h = new double [2*L+1];
+  h[L]=1.0;
+  if(M==1) return;
+
+  // Kaiser-windowed sinc
+  double fc = (fp+fs)/2.0; // cutoff: center of the transition band
+  double i0beta = TMath::BesselI0(beta);
+  double x, sum = 0.0;
+  for(int k=0; k<=L; k++){
+    x = (double)k/(double)L;
+    if(k) h[L+k] = TMath::Sin(2.0*TMath::Pi()*fc*(double)k)/(TMath::Pi()*(double)k);
+    else  h[L] = 2.0*fc;
+    h[L+k] *= TMath::BesselI0(beta*TMath::Sqrt(1.0-x*x))/i0beta;
+    h[L-k] = h[L+k];
+  }
+
+  // unity gain at DC
+  for(int k=0; k<2*L+1; k++) sum += h[k];
+  for(int k=0; k<2*L+1; k++) h[k] /= sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Odecimator::~Odecimator(void){
+////////////////////////////////////////////////////////////////////////////////////
+  delete [] h;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Odecimator::Decimate(const int aInSize, const double *aIn, double *aOut){
+////////////////////////////////////////////////////////////////////////////////////
+  if(!status_OK){
+    cerr<<"Odecimator::Decimate: the Odecimator object is corrupted"<<endl;
+    return false;
+  }
+  if(aInSize<=0||aInSize%M||aInSize<=2*L){
+    cerr<<"Odecimator::Decimate: the input vector size ("<<aInSize<<") is not compatible with the decimation factor ("<<M<<")"<<endl;
+    return false;
+  }
+
+  int outsize = aInSize/M;
+
+  // mean (the filter has a unity gain at DC)
+  double mean = 0.0;
+  for(int i=0; i<aInSize; i++) mean+=aIn[i];
+  mean/=(double)aInSize;
+
+  // output samples
+  int n, i1;
+  double s;
+  for(int j=0; j<outsize; j++){
+    n = j*M;
+
+    // edges: the input is mirrored
+    if(n<L||n+L>=aInSize){
+      s=0.0;
+      for(int k=-L; k<=L; k++){
+        i1=n+k;
+        if(i1<0) i1=-i1;
+        if(i1>=aInSize) i1=2*aInSize-2-i1;
+        s+=h[L+k]*aIn[i1];
+      }
+      aOut[j]=s-mean;
+    }
+
+    // scalar product
+    else aOut[j]=SimdDot(2*L+1, h, aIn+n-L)-mean;
+  }
+
+  return true;
+}
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#ifndef __Odecimator__
+#define __Odecimator__
+
+#include <TMath.h>
+#include "Osimd.h"
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Decimate a time series with a polyphase FIR filter.
+ * This class was designed to convert a time series sampled at a native frequency to a lower working frequency. The native frequency must be a multiple of the working frequency. The decimation factor is noted M.
+ *
+ * The anti-aliasing filter is a linear-phase FIR low-pass filter (Kaiser-windowed sinc). The passband extends to 90% of the working Nyquist frequency. The attenuation is 80 dB above the working Nyquist frequency: the aliased frequencies are suppressed by 80 dB. The filter length is derived from the transition band width: the filter half-length L is about 50 M samples. The filter is designed once, when the object is constructed. Only the output samples are computed: every output sample is the scalar product of the filter with the input samples around it (polyphase decimation). The input vector is read twice: a first pass computes the mean and a second pass computes the output samples. The scalar products are vectorized, see SimdDot().
+ *
+ * The filter has no delay (zero-phase). The input time series is mirrored at both ends. The mean of the input time series is removed.
+ * \author    Florent Robinet
+ */
+class Odecimator {
+
+ public:
+
+  /**
+   * Constructor of the Odecimator class.
+   * The filter is designed.
+   * @param aNativeFrequency native sampling frequency [Hz]
+   * @param aWorkingFrequency working sampling frequency [Hz]
+   */
+  Odecimator(const int aNativeFrequency, const int aWorkingFrequency);
+
+  /**
+   * Destructor of the Odecimator class.
+   */
+  virtual ~Odecimator(void);
+
+  /**
+   * Decimates a time series.
+   * The output vector must be allocated by the user with aInSize/M samples.
+   * @param aInSize input vector size
+   * @param aIn input vector (native frequency)
+   * @param aOut output vector (working frequency)
+   */
+  bool Decimate(const int aInSize, const double *aIn, double *aOut);
+
+  /**
+   * Returns the native sampling frequency [Hz].
+   */
+  inline int GetNativeFrequency(void){ return native; };
+
+  /**
+   * Returns the working sampling frequency [Hz].
+   */
+  inline int GetWorkingFrequency(void){ return working; };
+
+  /**
+   * Returns the status of the object.
+   */
+  inline bool GetStatus(void){ return status_OK; };
+
+ private:
+
+  bool status_OK;               ///< class status
+  int native;                   ///< native sampling frequency
+  int working;                  ///< working sampling frequency
+  int M;                        ///< decimation factor
+  int L;                        ///< filter half-length
+  double *h;                    ///< filter coefficients (2L+1, symmetric)
+
+};
+
+#endif
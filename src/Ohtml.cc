@@ -160,7 +160,7 @@ void Omicron::MakeHtml(void){
     report<<"</table>"<<endl;
     report<<"<table>"<<endl;
     report<<"  <tr><th>Main channel</th><th>Injection channel</th><th>Injection factor</th></tr>"<<endl;
-    for(int c=0; c<nchannels; c++) report<<"  <tr><td>"<<triggers[c]->GetName()<<"</td><td>"<<fInjChan[c]<<"</td><td>"<<fInjFact[c]<<"</td></tr>"<<endl;
+    for(int c=0; c<(int)fChannels.size(); c++) report<<"  <tr><td>"<<fChannels[c]<<"</td><td>"<<fInjChan[c]<<"</td><td>"<<fInjFact[c]<<"</td></tr>"<<endl;
     report<<"</table>"<<endl;
   }
   if(!fsginj&&FFL_inject==NULL)
@@ -178,15 +178,15 @@ void Omicron::MakeHtml(void){
   }
   report<<"<table class=\"omicronindex\">"<<endl;
   string colcode;
-  for(int c=0; c<nchannels; c++){
+  for(int c=0; c<(int)fChannels.size(); c++){
     colcode="";
     if(tile->GetSNRMapThr()>0) colcode=GetColorCode((chan_mapsnrmax[c]-tile->GetSNRMapThr())/tile->GetSNRMapThr());
     if(!(c%6)) report<<"  <tr>"<<endl;
-    if(colcode.compare("")) report<<"    <td style=\"border:2px solid "<<colcode<<"\"><a href=\"#"<<triggers[c]->GetNameConv()<<"\">"<<triggers[c]->GetName()<<"</a></td>"<<endl;
-    else report<<"    <td><a href=\"#"<<triggers[c]->GetNameConv()<<"\">"<<triggers[c]->GetName()<<"</a></td>"<<endl;
+    if(colcode.compare("")) report<<"    <td style=\"border:2px solid "<<colcode<<"\"><a href=\"#"<<fChannelsConv[c]<<"\">"<<fChannels[c]<<"</a></td>"<<endl;
+    else report<<"    <td><a href=\"#"<<fChannelsConv[c]<<"\">"<<fChannels[c]<<"</a></td>"<<endl;
     if(!((c+1)%6)) report<<"  </tr>"<<endl;
   }
-  for(int c=0; c<6-(nchannels)%6; c++) report<<"    <td></td>"<<endl;
+  for(int c=0; c<6-((int)fChannels.size())%6; c++) report<<"    <td></td>"<<endl;
   report<<"  </tr>"<<endl;
   report<<"</table>"<<endl;
   report<<"<hr />"<<endl;
@@ -194,7 +194,7 @@ void Omicron::MakeHtml(void){
 
   //**** channel report *********
   string type_first="", led, led_h;
-  for(int c=0; c<nchannels; c++){
+  for(int c=0; c<(int)fChannels.size(); c++){
 
     // select processing led
     if(chan_write_ctr[c]==chunk_ctr){ led="green"; led_h="Processing OK"; }
@@ -206,17 +206,17 @@ void Omicron::MakeHtml(void){
 
     // processing report
     if(fOutProducts.find("map")!=string::npos&&chan_mapsnrmax[c]<tile->GetSNRMapThr()){
-      report<<"<h2 class=\"off\"><img src=\"./led-"<<led<<".gif\" alt=\""<<led_h<<"\" title=\""<<led_h<<"\"/>&nbsp;"<<triggers[c]->GetName()<<" <a href=\"javascript:void(0)\" name=\""<<triggers[c]->GetNameConv()<<"\" onclick=\"toggle('id_"<<triggers[c]->GetNameConv()<<"')\">[click here to expand/hide]</a></h2>"<<endl;
-      report<<"<div class=\"omicronchannel\" id=\"id_"<<triggers[c]->GetNameConv()<<"\" style=\"visibility:hidden;height:0;\">"<<endl;
+      report<<"<h2 class=\"off\"><img src=\"./led-"<<led<<".gif\" alt=\""<<led_h<<"\" title=\""<<led_h<<"\"/>&nbsp;"<<fChannels[c]<<" <a href=\"javascript:void(0)\" name=\""<<fChannelsConv[c]<<"\" onclick=\"toggle('id_"<<fChannelsConv[c]<<"')\">[click here to expand/hide]</a></h2>"<<endl;
+      report<<"<div class=\"omicronchannel\" id=\"id_"<<fChannelsConv[c]<<"\" style=\"visibility:hidden;height:0;\">"<<endl;
     }
     else{
-      report<<"<h2 class=\"on\"><img src=\"./led-"<<led<<".gif\" />&nbsp;"<<triggers[c]->GetName()<<" <a href=\"javascript:void(0)\" name=\""<<triggers[c]->GetNameConv()<<"\" onclick=\"toggle('id_"<<triggers[c]->GetNameConv()<<"')\">[click here to expand/hide]</a></h2>"<<endl;
-      report<<"<div class=\"omicronchannel\" id=\"id_"<<triggers[c]->GetNameConv()<<"\" style=\"visibility:visible;height:auto;\">"<<endl;
+      report<<"<h2 class=\"on\"><img src=\"./led-"<<led<<".gif\" />&nbsp;"<<fChannels[c]<<" <a href=\"javascript:void(0)\" name=\""<<fChannelsConv[c]<<"\" onclick=\"toggle('id_"<<fChannelsConv[c]<<"')\">[click here to expand/hide]</a></h2>"<<endl;
+      report<<"<div class=\"omicronchannel\" id=\"id_"<<fChannelsConv[c]<<"\" style=\"visibility:visible;height:auto;\">"<<endl;
     }
     report<<"Processing:"<<endl;
     report<<"  <table class=\"omicronsummary\">"<<endl;
     report<<"    <tr><td>Number of calls [load/data/condition/projection/write]:</td><td>"<<chan_ctr[c]<<"/"<<chan_data_ctr[c]<<"/"<<chan_cond_ctr[c]<<"/"<<chan_proj_ctr[c]<<"/"<<chan_write_ctr[c]<<"</td></tr>"<<endl;
-    report<<"    <tr><td>Processed livetime:</td><td>"<<(int)outSegments[c]->GetLiveTime()<<" sec ("<<setprecision(3)<<fixed<<outSegments[c]->GetLiveTime()/inSegments->GetLiveTime()*100.0<<"%) &rarr; "<<setprecision(3)<<fixed<<outSegments[c]->GetLiveTime()/3600.0/24<<" days <a href=\"./"<<triggers[c]->GetName()<<"/omicron.segments.txt\">segments</a></td></tr>"<<endl;
+    report<<"    <tr><td>Processed livetime:</td><td>"<<(int)outSegments[c]->GetLiveTime()<<" sec ("<<setprecision(3)<<fixed<<outSegments[c]->GetLiveTime()/inSegments->GetLiveTime()*100.0<<"%) &rarr; "<<setprecision(3)<<fixed<<outSegments[c]->GetLiveTime()/3600.0/24<<" days <a href=\"./"<<fChannels[c]<<"/omicron.segments.txt\">segments</a></td></tr>"<<endl;
     report<<"  </table>"<<endl;
     
     // output products
@@ -231,24 +231,24 @@ void Omicron::MakeHtml(void){
 
       // triggers
       if(fOutProducts.find("triggers")!=string::npos){
-	if(chunktfile[s].compare("none")) report<<"    <td><a href=\"./"<<triggers[c]->GetName()<<"/"<<chunktfile[s]<<"\">Triggers</a></td>"<<endl;
+	if(chunktfile[s].compare("none")) report<<"    <td><a href=\"./"<<fChannels[c]<<"/"<<chunktfile[s]<<"\">Triggers</a></td>"<<endl;
 	else report<<"    <td>Triggers</td>"<<endl;
       }
       
       // maps
       if(fOutProducts.find("map")!=string::npos){
 	tmpstream.clear(); tmpstream.str("");
-	tmpstream<<outdir[c]<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONMAP-"<<chunkcenter[s]<<"-"<<fWindows[0]<<"."<<form;
+	tmpstream<<outdir[c]<<"/"<<fChannelsConv[c]<<"_OMICRONMAP-"<<chunkcenter[s]<<"-"<<fWindows[0]<<"."<<form;
 	if(IsBinaryFile(tmpstream.str())){
 	  for(int q=0; q<=tile->GetNQ(); q++){
 	    if(q){
-	      report<<"    <td><a href=\"javascript:showImage('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONMAPQ"<<q-1<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">mapQ="<<setprecision(1)<<fixed<<tile->GetQ(q-1)<<"</a>";
-	      if(tile->GetChirpMass()>0) report<<"<a href=\"javascript:showImage('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONMAPQ"<<q-1<<"C-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">(C)</a>";
+	      report<<"    <td><a href=\"javascript:showImage('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONMAPQ"<<q-1<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">mapQ="<<setprecision(1)<<fixed<<tile->GetQ(q-1)<<"</a>";
+	      if(tile->GetChirpMass()>0) report<<"<a href=\"javascript:showImage('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONMAPQ"<<q-1<<"C-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">(C)</a>";
 	      report<<"</td>"<<endl;
 	    }
 	    else{
-	      report<<"    <td><a href=\"javascript:showImage('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONMAP"<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">Full map</a>";
-	      if(tile->GetChirpMass()>0) report<<"<a href=\"javascript:showImage('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONMAPC-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">(C)</a>";
+	      report<<"    <td><a href=\"javascript:showImage('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONMAP"<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">Full map</a>";
+	      if(tile->GetChirpMass()>0) report<<"<a href=\"javascript:showImage('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONMAPC-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">(C)</a>";
 	      report<<"</td>"<<endl;
 	    }
 	  }
@@ -263,33 +263,33 @@ void Omicron::MakeHtml(void){
       
       // ASD
       if(fOutProducts.find("asd")!=string::npos)
-	report<<"    <td><a href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONASD-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">ASD</a></td>"<<endl;
+	report<<"    <td><a href=\"./"<<fChannels[c]<<"/"<<fChannelsConv[c]<<"_OMICRONASD-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">ASD</a></td>"<<endl;
 	
       // PSD
       if(fOutProducts.find("psd")!=string::npos)
-	report<<"    <td><a href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONPSD-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">PSD</a></td>"<<endl;
+	report<<"    <td><a href=\"./"<<fChannels[c]<<"/"<<fChannelsConv[c]<<"_OMICRONPSD-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">PSD</a></td>"<<endl;
 	
       // PSD variance
       if(fOutProducts.find("psdvariance")!=string::npos)
-	report<<"    <td><a href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONPSDV-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">PSD variance</a></td>"<<endl;
+	report<<"    <td><a href=\"./"<<fChannels[c]<<"/"<<fChannelsConv[c]<<"_OMICRONPSDV-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">PSD variance</a></td>"<<endl;
 	
       // whitened PSD
       if(fOutProducts.find("whitepsd")!=string::npos)
-	report<<"    <td><a href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONWPSD-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">Whitened PSD</a></td>"<<endl;
+	report<<"    <td><a href=\"./"<<fChannels[c]<<"/"<<fChannelsConv[c]<<"_OMICRONWPSD-"<<chunkcenter[s]-tile->GetTimeRange()/2<<"-"<<tile->GetTimeRange()<<"."<<form<<"\" target=\"_blank\">Whitened PSD</a></td>"<<endl;
       
       // conditioned time-series
       if(fOutProducts.find("timeseries")!=string::npos){
-	report<<"    <td><a href=\"javascript:showImage('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONCONDTS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">Conditioned data"<<"</a>";
+	report<<"    <td><a href=\"javascript:showImage('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONCONDTS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">Conditioned data"<<"</a>";
  	if(fOutFormat.find("wav")!=string::npos)
-	  report<<" <a href=\"javascript:showSound('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONCONDTS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<");\">(.wav)</a>";
+	  report<<" <a href=\"javascript:showSound('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONCONDTS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<");\">(.wav)</a>";
         report<<"    </td>"<<endl;
       }
       
       // whitened time-series
       if(fOutProducts.find("white")!=string::npos){
-	report<<"    <td><a href=\"javascript:showImage('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONWHITETS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">Whitened data"<<"</a>";
+	report<<"    <td><a href=\"javascript:showImage('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONWHITETS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<", '"<<form<<"');\">Whitened data"<<"</a>";
 	if(fOutFormat.find("wav")!=string::npos)
-	  report<<" <a href=\"javascript:showSound('"<<triggers[c]->GetName()<<"', '"<<triggers[c]->GetNameConv()<<"', 'OMICRONWHITETS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<");\">(.wav)</a>";
+	  report<<" <a href=\"javascript:showSound('"<<fChannels[c]<<"', '"<<fChannelsConv[c]<<"', 'OMICRONWHITETS"<<"-"<<chunkcenter[s]<<"', "<<windowset<<");\">(.wav)</a>";
         report<<"    </td>"<<endl;
       }
       
@@ -299,7 +299,7 @@ void Omicron::MakeHtml(void){
              
       // injection
       if(fsginj==1&&fOutProducts.find("injection")!=string::npos){
-      report<<"    <td><a href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetName()<<"_"<<chunkstart[s]<<"_sginjection.txt\">Injection</a></td>"<<endl;
+      report<<"    <td><a href=\"./"<<fChannels[c]<<"/"<<fChannels[c]<<"_"<<chunkstart[s]<<"_sginjection.txt\">Injection</a></td>"<<endl;
       if(!type_first.compare("")) type_first="injection";
       }
       report<<"  </tr>"<<endl;
@@ -313,7 +313,7 @@ void Omicron::MakeHtml(void){
       report<<"<table>"<<endl;
       report<<"  <tr>"<<endl;
       for(int w=0; w<(int)fWindows.size(); w++)
-	report<<"    <td><a id=\"a_"<<triggers[c]->GetNameConv()<<"-"<<fWindows[w]<<"\" href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONMAP-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\"><img id=\"img_"<<triggers[c]->GetNameConv()<<"-"<<fWindows[w]<<"\" src=\"./"<<triggers[c]->GetName()<<"/th"<<triggers[c]->GetNameConv()<<"_OMICRONMAP-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\" alt=\""<<triggers[c]->GetName()<<" "<<fWindows[w]<<"s\" /></a></td>"<<endl;
+	report<<"    <td><a id=\"a_"<<fChannelsConv[c]<<"-"<<fWindows[w]<<"\" href=\"./"<<fChannels[c]<<"/"<<fChannelsConv[c]<<"_OMICRONMAP-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\"><img id=\"img_"<<fChannelsConv[c]<<"-"<<fWindows[w]<<"\" src=\"./"<<fChannels[c]<<"/th"<<fChannelsConv[c]<<"_OMICRONMAP-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\" alt=\""<<fChannels[c]<<" "<<fWindows[w]<<"s\" /></a></td>"<<endl;
       report<<"  </tr>"<<endl;
       report<<"</table>"<<endl;
     }
@@ -321,7 +321,7 @@ void Omicron::MakeHtml(void){
       report<<"<table>"<<endl;
       report<<"  <tr>"<<endl;
       for(int w=0; w<(int)fWindows.size(); w++)
-	report<<"    <td><a id=\"a_"<<triggers[c]->GetNameConv()<<"-"<<fWindows[w]<<"\" href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONWHITETS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\"><img id=\"img_"<<triggers[c]->GetNameConv()<<"-"<<fWindows[w]<<"\" src=\"./"<<triggers[c]->GetName()<<"/th"<<triggers[c]->GetNameConv()<<"_OMICRONWHITETS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\" alt=\""<<triggers[c]->GetName()<<" "<<fWindows[w]<<"s\" /></a></td>"<<endl;
+	report<<"    <td><a id=\"a_"<<fChannelsConv[c]<<"-"<<fWindows[w]<<"\" href=\"./"<<fChannels[c]<<"/"<<fChannelsConv[c]<<"_OMICRONWHITETS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\"><img id=\"img_"<<fChannelsConv[c]<<"-"<<fWindows[w]<<"\" src=\"./"<<fChannels[c]<<"/th"<<fChannelsConv[c]<<"_OMICRONWHITETS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\" alt=\""<<fChannels[c]<<" "<<fWindows[w]<<"s\" /></a></td>"<<endl;
       report<<"  </tr>"<<endl;
       report<<"</table>"<<endl;
     }
@@ -329,7 +329,7 @@ void Omicron::MakeHtml(void){
       report<<"<table>"<<endl;
       report<<"  <tr>"<<endl;
       for(int w=0; w<(int)fWindows.size(); w++)
-	report<<"    <td><a id=\"a_"<<triggers[c]->GetNameConv()<<"-"<<fWindows[w]<<"\" href=\"./"<<triggers[c]->GetName()<<"/"<<triggers[c]->GetNameConv()<<"_OMICRONCONDTS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\"><img id=\"img_"<<triggers[c]->GetNameConv()<<"-"<<fWindows[w]<<"\" src=\"./"<<triggers[c]->GetName()<<"/th"<<triggers[c]->GetNameConv()<<"_OMICRONCONDTS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\" alt=\""<<triggers[c]->GetName()<<" "<<fWindows[w]<<"s\" /></a></td>"<<endl;
+	report<<"    <td><a id=\"a_"<<fChannelsConv[c]<<"-"<<fWindows[w]<<"\" href=\"./"<<fChannels[c]<<"/"<<fChannelsConv[c]<<"_OMICRONCONDTS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\"><img id=\"img_"<<fChannelsConv[c]<<"-"<<fWindows[w]<<"\" src=\"./"<<fChannels[c]<<"/th"<<fChannelsConv[c]<<"_OMICRONCONDTS-"<<chunkcenter[0]<<"-"<<fWindows[w]<<"."<<form<<"\" alt=\""<<fChannels[c]<<" "<<fWindows[w]<<"s\" /></a></td>"<<endl;
       report<<"  </tr>"<<endl;
       report<<"</table>"<<endl;
     }
@@ -62,7 +62,25 @@ double Oinject::GetTrueSNR(Spectrum *aSpec1, Spectrum *aSpec2){
     sum += win*win/2.0 / sqrt(aSpec1->GetPower(freq)*aSpec2->GetPower(freq)/4.0) * dfreq;
   }
 
-  return amp*sum;
+  // optimal SNR: SNR^2 = 4 int |h(f)|^2/S(f) df
+  return amp*sqrt(sum);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Oinject::GetWaveformFT(const double aFrequency, double &aRe, double &aIm){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // Gaussian window in the frequency domain (positive and negative frequency)
+  double gp = amp/2.0*Wg*exp(-(aFrequency-phi)*(aFrequency-phi)/2.0/sigma_f/sigma_f);
+  double gn = amp/2.0*Wg*exp(-(aFrequency+phi)*(aFrequency+phi)/2.0/sigma_f/sigma_f);
+
+  // phase: sine phase + time shift (injection time and vector start)
+  double argp =  phase-2.0*TMath::Pi()*((aFrequency-phi)*tau+aFrequency*duration/2.0);
+  double argn = -phase-2.0*TMath::Pi()*((aFrequency+phi)*tau+aFrequency*duration/2.0);
+
+  aRe = gp*TMath::Cos(argp) + gn*TMath::Cos(argn);
+  aIm = gp*TMath::Sin(argp) + gn*TMath::Sin(argn);
+  return;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
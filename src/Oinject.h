@@ -71,8 +71,18 @@ class Oinject{
       TMath::Cos(2.0*TMath::Pi()*phi*(-duration/2.0+(double)aIndex/(double)aSamplingFrequency)+phase);// sine
   };
 
+  /**
+   * Returns the Fourier transform of the waveform for a given frequency.
+   * The continuous Fourier transform of the waveform is computed analytically, with the parameters previously generated with MakeWaveform(). The time origin is the start of the waveform vector, as for GetWaveform(). Both the positive and the negative frequency components are included.
+   * @param aFrequency frequency [Hz]
+   * @param aRe returned real part
+   * @param aIm returned imaginary part
+   */
+  void GetWaveformFT(const double aFrequency, double &aRe, double &aIm);
+
   /**
    * Returns the true value of SNR.
+   * The SNR is computed analytically in the frequency domain, with the parameters previously generated with MakeWaveform(): the squared Gaussian window is weighted by the inverse noise amplitude and summed over the positive frequency bins of the spectra. This is the optimal (matched-filter) SNR. No time-domain waveform is built: the cost only scales with the spectrum size, not with the chunk size.
    * @param aSpec1 noise spectrum (1)
    * @param aSpec2 noise spectrum (2)
    */
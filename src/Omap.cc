@@ -6,30 +6,55 @@
 ClassImp(Omap)
 
 ////////////////////////////////////////////////////////////////////////////////////
-Omap::Omap(): TH2D(){ 
+Omap::Omap(){ 
 ////////////////////////////////////////////////////////////////////////////////////
-  GetXaxis()->SetTitle("Time [s]");
-  GetYaxis()->SetTitle("Frequency [Hz]");
-  GetXaxis()->SetNoExponent();
-  GetXaxis()->SetNdivisions(4,5,0);
-  GetXaxis()->SetLabelSize(0.045);
-  GetYaxis()->SetLabelSize(0.045);
-  GetZaxis()->SetLabelSize(0.045);
-  GetXaxis()->SetTitleSize(0.045);
-  GetYaxis()->SetTitleSize(0.045);
-  GetZaxis()->SetTitleSize(0.045);
+  name="omap";
+  timeRange=0;
+  ntbins=0;
+  nbands=0;
   Ntiles=0;
+  bandEdge       = new double[0];
   bandMultiple   = new int[0];
   bandCenter     = new double[0];
+  map            = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
 Omap::~Omap(void){
 ////////////////////////////////////////////////////////////////////////////////////
+  if(map!=NULL) delete map;
+  delete [] bandEdge;
   delete bandCenter;
   delete bandMultiple;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+TH2D* Omap::GetMap(void){
+////////////////////////////////////////////////////////////////////////////////////
+  if(map!=NULL) return map;
+
+  // time bins
+  double *tbins = new double [ntbins+1];
+  for(int t=0; t<=ntbins; t++) tbins[t] = GetTimeBinEdge(t);
+
+  // map histogram
+  map = new TH2D(name.c_str(), name.c_str(), ntbins, tbins, nbands, bandEdge);
+  map->SetDirectory(0);// owned by this map
+  delete [] tbins;
+  map->GetXaxis()->SetTitle("Time [s]");
+  map->GetYaxis()->SetTitle("Frequency [Hz]");
+  map->GetXaxis()->SetNoExponent();
+  map->GetXaxis()->SetNdivisions(4,5,0);
+  map->GetXaxis()->SetLabelSize(0.045);
+  map->GetYaxis()->SetLabelSize(0.045);
+  map->GetZaxis()->SetLabelSize(0.045);
+  map->GetXaxis()->SetTitleSize(0.045);
+  map->GetYaxis()->SetTitleSize(0.045);
+  map->GetZaxis()->SetTitleSize(0.045);
+
+  return map;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 void Omap::SetBins(const double aQ, const double aFrequencyMin, const double aFrequencyMax,
 		   const int aTimeRange, const double aMismatchStep){
@@ -49,14 +74,14 @@ void Omap::SetBins(const double aQ, const double aFrequencyMin, const double aFr
   double TimeCumulativeMismatch = (double)aTimeRange * 2.0*TMath::Pi() * sqrt(fbins[Nf-1]*fbins[Nf]) / aQ;
   int Nt = NextPowerOfTwo(TimeCumulativeMismatch / aMismatchStep);
 
-  // time bins (linear)
-  double *tbins = new double [Nt+1];
-  for(int t=0; t<=Nt; t++) tbins[t] = -(double)aTimeRange/2.0 + (double)t/(double)Nt*(double)aTimeRange;
-
   // set binning
-  TH1::SetBins(Nt,tbins, Nf,fbins);
-  delete fbins;
-  delete tbins;
+  // the time bins are linear: see GetTimeBinEdge()
+  timeRange=aTimeRange;
+  ntbins=Nt;
+  nbands=Nf;
+  delete [] bandEdge;
+  bandEdge=fbins;
+  if(map!=NULL){ delete map; map=NULL; }
  
   // band parameters
   delete bandCenter;
@@ -67,10 +92,10 @@ void Omap::SetBins(const double aQ, const double aFrequencyMin, const double aFr
 
   //
   for(int f=0; f<GetNBands(); f++){
-    bandCenter[f] = GetYaxis()->GetBinCenterLog(f+1);
+    bandCenter[f] = TMath::Sqrt(bandEdge[f]*bandEdge[f+1]);// log bin center
     TimeCumulativeMismatch = (double)aTimeRange * 2.0*TMath::Pi() * GetBandFrequency(f) / aQ;
     Nt = NextPowerOfTwo(TimeCumulativeMismatch / aMismatchStep);
-    bandMultiple[f] = GetNbinsX() / Nt;
+    bandMultiple[f] = ntbins / Nt;
     
     Ntiles+=(long int)Nt;
   }
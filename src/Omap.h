@@ -6,6 +6,7 @@
 #include <CUtils.h>
 #include <TMath.h>
 #include <TH2D.h>
+#include <algorithm>
 
 using namespace std;
 
@@ -13,9 +14,11 @@ using namespace std;
  * Create a time-frequency map.
  * This class was designed to create and use a multi-resolution time-frequency map.
  *
+ * The map geometry (frequency bands and time tiles) is held in a compact form. The time bins are linear and computed on the fly. A ROOT TH2D histogram is only created when the map content is needed (to draw the map, see GetMap()).
+ *
  * \author    Florent Robinet
  */
-class Omap: public TH2D {
+class Omap {
 
  public:
   friend class Otile;   ///< Friendly class
@@ -31,54 +34,61 @@ class Omap: public TH2D {
 	       const double aFrequencyMin, const double aFrequencyMax,
 	       const int aTimeRange, const double aMismatchStep);
 
+  // map histogram (created when first called)
+  TH2D* GetMap(void);
+
+  inline void SetName(const string aName){ name=aName; };
+  
   inline double GetTimeRange(void){
-    return GetXaxis()->GetBinUpEdge(GetNbinsX())-GetXaxis()->GetBinLowEdge(1); 
+    return GetTimeBinEdge(ntbins)-GetTimeBinEdge(0); 
   };
   inline double GetTimeMin(void){ 
-    return GetXaxis()->GetBinLowEdge(1); 
+    return GetTimeBinEdge(0); 
   };
   inline double GetTimeMax(void){ 
-    return GetXaxis()->GetBinUpEdge(GetNbinsX()); 
+    return GetTimeBinEdge(ntbins); 
   };
   inline double GetFrequencyMin(void){ 
-    return GetYaxis()->GetBinLowEdge(1); 
+    return bandEdge[0]; 
   };
   inline double GetFrequencyMax(void){ 
-    return GetYaxis()->GetBinUpEdge(GetNbinsY()); 
+    return bandEdge[nbands]; 
   };
   inline int GetNBands(void){ 
-    return GetNbinsY();
+    return nbands;
   };
   inline long int GetNTiles(void){ 
     return Ntiles;
   };
   inline int GetBandIndex(const double aFrequency){
-    return GetYaxis()->FindBin(aFrequency)-1;
+    if(aFrequency<bandEdge[0]) return -1;
+    if(aFrequency>=bandEdge[nbands]) return nbands;
+    return (int)(upper_bound(bandEdge, bandEdge+nbands+1, aFrequency)-bandEdge)-1;
   };
   inline double GetBandFrequency(const int aBandIndex){
     return bandCenter[aBandIndex];
   };
   inline double GetBandStart(const int aBandIndex){ 
-    return GetYaxis()->GetBinLowEdge(aBandIndex+1);
+    return bandEdge[aBandIndex];
   };
   inline double GetBandEnd(const int aBandIndex){ 
-    return GetYaxis()->GetBinUpEdge(aBandIndex+1);
+    return bandEdge[aBandIndex+1];
   };
   inline double GetBandWidth(const int aBandIndex){ 
-    return GetYaxis()->GetBinWidth(aBandIndex+1);
+    return bandEdge[aBandIndex+1]-bandEdge[aBandIndex];
   };
   inline double GetTileDuration(const int aBandIndex){
-    return GetXaxis()->GetBinWidth(1)*bandMultiple[aBandIndex];
+    return (GetTimeBinEdge(1)-GetTimeBinEdge(0))*bandMultiple[aBandIndex];
   };
   inline int GetBandNtiles(const int aBandIndex){ 
-    return GetNbinsX()/bandMultiple[aBandIndex];
+    return ntbins/bandMultiple[aBandIndex];
   };
 
   inline double GetTileTimeStart(const int aTimeTileIndex, const int aBandIndex){
-    return GetXaxis()->GetBinLowEdge(aTimeTileIndex*bandMultiple[aBandIndex]+1);
+    return GetTimeBinEdge(aTimeTileIndex*bandMultiple[aBandIndex]);
   };
   inline double GetTileTimeEnd(const int aTimeTileIndex, const int aBandIndex){
-    return GetXaxis()->GetBinUpEdge((aTimeTileIndex+1)*bandMultiple[aBandIndex]);
+    return GetTimeBinEdge((aTimeTileIndex+1)*bandMultiple[aBandIndex]);
   };
   inline double GetTileTime(const int aTimeTileIndex, const int aBandIndex){
     return (GetTileTimeStart(aTimeTileIndex,aBandIndex) + GetTileTimeEnd(aTimeTileIndex,aBandIndex)) / 2.0;
@@ -88,17 +98,30 @@ class Omap: public TH2D {
   };
 
   inline double GetTileContent(const int aTimeTileIndex, const int aBandIndex){
-    return TH2::GetBinContent(aTimeTileIndex*bandMultiple[aBandIndex]+1,aBandIndex+1);
+    if(map==NULL) return 0.0;
+    return map->GetBinContent(aTimeTileIndex*bandMultiple[aBandIndex]+1,aBandIndex+1);
   };
   inline void SetTileContent(const int aTimeTileIndex, const int aBandIndex, const double aContent){
+    TH2D *h=GetMap();
     int tstart=aTimeTileIndex*bandMultiple[aBandIndex]+1;
     int tend=tstart+bandMultiple[aBandIndex];
-    for(int t=tstart; t<tend; t++) TH2::SetBinContent(t,aBandIndex+1,aContent);
+    for(int t=tstart; t<tend; t++) h->SetBinContent(t,aBandIndex+1,aContent);
+  };
+
+  // time bin edges (linear)
+  inline double GetTimeBinEdge(const int aTimeBinIndex){
+    return -(double)timeRange/2.0 + (double)aTimeBinIndex/(double)ntbins*(double)timeRange;
   };
 
+  string name;                      ///< map name
+  int timeRange;                    ///< time range [s]
+  int ntbins;                       ///< number of time bins (finest time resolution)
+  int nbands;                       ///< number of frequency bands
+  double *bandEdge;                 ///< frequency band edges (nbands+1)
   long int Ntiles;                  ///< number of tiles in the plane
   double *bandCenter;               ///< frequency bin center
   int *bandMultiple;                ///< band multiple (time resolution)
+  TH2D *map;                        //!< map histogram (NULL until needed)
 
   ClassDef(Omap,0)  
 };
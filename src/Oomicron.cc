@@ -2,16 +2,50 @@
 //  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
 //////////////////////////////////////////////////////////////////////////////
 #include "Oomicron.h"
+#include "Oprefetch.h"
+#include "Odecimator.h"
+#include "Oarena.h"
+#include <FrameL.h>
+#include <cstring>
+#include <mutex>
+#include <TROOT.h>
 
 ClassImp(Omicron)
 
+/**
+ * @brief Serialize frame reading across Omicron objects.
+ */
+static mutex omicron_read_mtx;
+
+/**
+ * @brief Serialize output writing across Omicron objects.
+ */
+static mutex omicron_write_mtx;
+
+/**
+ * @brief Process-wide initialization flag.
+ */
+static once_flag omicron_init_flag;
 
 ////////////////////////////////////////////////////////////////////////////////////
-Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict){ 
+static void OmicronInit(void){
 ////////////////////////////////////////////////////////////////////////////////////
-  PrintASCIIlogo();
+  ROOT::EnableThreadSafety();
   gErrorIgnoreLevel = 3000;
+  return;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////
+Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict, const int aChannelGroup){ 
+////////////////////////////////////////////////////////////////////////////////////
+  // process-wide initialization
+  call_once(omicron_init_flag, OmicronInit);
+
+  PrintASCIIlogo();
   status_OK=true;
+  changroup=0;
+  nchangroups=1;
 
   // init timer
   time ( &timer );
@@ -20,7 +54,11 @@ Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict
   // parse option file
   if(fVerbosity) cout<<"Omicron::Omicron: init options..."<<endl;
   fOptionFile=aOptionFile;
-  ReadOptions(aGpsRef, aStrict);
+  ReadOptions(aGpsRef, aStrict, aChannelGroup);
+
+  // data prefetch
+  if(fPrefetch>0&&FFL!=NULL) prefetch = new Oprefetch(fPrefetch, &omicron_read_mtx);
+  else prefetch = NULL;
 
   // sort time windows
   // FIXME: to move in Otile
@@ -30,13 +68,35 @@ Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict
   for(int c=0; c<nchannels; c++) status_OK*=spectrum1[c]->GetStatus()*spectrum2[c]->GetStatus()*spectrumw->GetStatus();
 
   // chunk FFT
-  offt = new fft(tile->GetTimeRange()*triggers[0]->GetWorkingFrequency(), fftplan, "r2c");
+  // the FFTW planner is not thread-safe: the plans are created one at a time
+  {
+    lock_guard<recursive_mutex> plock(OfftwPlannerMutex());
+    offt = new fft(tile->GetTimeRange()*triggers[0]->GetWorkingFrequency(), fftplan, "r2c");
+
+    // save fft plans for the next jobs
+    if(fftwisdom.compare("none")) ExportFftWisdom();
+  }
  
   // data containers
   ChunkVect     = new double    [offt->GetSize_t()];
+  WorkVect      = new double    [offt->GetSize_t()];
+  arena         = new Oarena(2*nchannels+1, fHugePages);
+  DataVect      = NULL;// in the arena, allocated when needed
+  WhiteVect_r   = new double    [offt->GetSize_f()];
+  WhiteVect_i   = new double    [offt->GetSize_f()];
+  InvASD        = new double*   [2*nchannels];
+  InvASDVersion = new long int  [2*nchannels];
+  SpecVersion   = new long int  [2*nchannels];
+  for(int s=0; s<2*nchannels; s++){
+    InvASD[s]        = NULL;// allocated when needed
+    InvASDVersion[s] = -1;
+    SpecVersion[s]   = 0;
+  }
+  PsdVect       = NULL;// allocated when needed
+  PsdSize       = 0;
   TukeyWindow   = GetTukeyWindow(offt->GetSize_t(),
 				 tile->GetOverlapDuration()*triggers[0]->GetWorkingFrequency());
- 
+
   // metadata field definition
   vector <string> fOptionName;
   vector <string> fOptionType;
@@ -78,8 +138,11 @@ Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict
   fOptionName.push_back("omicron_OUTPUT_PLOTHEIGHT");           fOptionType.push_back("i");
   fOptionName.push_back("omicron_OUTPUT_PRODUCTS");             fOptionType.push_back("s");
   fOptionName.push_back("omicron_OUTPUT_STYLE");                fOptionType.push_back("s");
+  fOptionName.push_back("omicron_PARAMETER_PRECISION");         fOptionType.push_back("s");
+  fOptionName.push_back("omicron_PARAMETER_SPARSEPROJECTION");  fOptionType.push_back("i");
 
-  // triggers metadata
+  // triggers metadata (ROOT objects)
+  unique_lock<recursive_mutex> plock(OfftwPlannerMutex());
   for(int c=0; c<nchannels; c++){
     triggers[c]->SetMprocessname("OMICRON");
     triggers[c]->SetProcessVersion((string)O_PROJECT_VERSION);
@@ -91,8 +154,8 @@ Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict
     if(FFL_inject==NULL) status_OK*=triggers[c]->SetUserMetaData(fOptionName[3],"none");
     else                 status_OK*=triggers[c]->SetUserMetaData(fOptionName[3],FFL_inject->GetInputFfl());
     if(fInjChan.size()){
-      status_OK*=triggers[c]->SetUserMetaData(fOptionName[4],fInjChan[c]);
-      status_OK*=triggers[c]->SetUserMetaData(fOptionName[5],fInjFact[c]);
+      status_OK*=triggers[c]->SetUserMetaData(fOptionName[4],fInjChan[changroup+c*nchangroups]);
+      status_OK*=triggers[c]->SetUserMetaData(fOptionName[5],fInjFact[changroup+c*nchangroups]);
     }
     else{
       status_OK*=triggers[c]->SetUserMetaData(fOptionName[4],"none");
@@ -130,11 +193,14 @@ Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict
     status_OK*=triggers[c]->SetUserMetaData(fOptionName[34],tile->GetWidth());
     status_OK*=triggers[c]->SetUserMetaData(fOptionName[35],tile->GetHeight());
     status_OK*=triggers[c]->SetUserMetaData(fOptionName[36],tile->GetCurrentStyle());
+    status_OK*=triggers[c]->SetUserMetaData(fOptionName[37],tile->GetPrecision());
+    status_OK*=triggers[c]->SetUserMetaData(fOptionName[38],(int)tile->GetSparseProjection());
   }
+  plock.unlock();
 
   // default output directory: main dir
   maindir=fMaindir;
-  for(int c=0; c<nchannels; c++){
+  for(int c=0; c<(int)fChannels.size(); c++){
     outdir.push_back(maindir);
   }
   
@@ -148,19 +214,36 @@ Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict
   // default plottime offset
   SetPlotTimeOffset();
 
-  // process monitoring
+  // process monitoring (all groups)
   chanindex      = -1;
+  changlobal     = -1;
   inSegments     = new Segments();
-  outSegments    = new Segments* [nchannels];
+  outSegments    = new Segments* [fChannels.size()];
   chunk_ctr      = 0;
-  chan_ctr       = new int       [nchannels];
-  chan_data_ctr  = new int       [nchannels];
-  chan_cond_ctr  = new int       [nchannels];
-  chan_proj_ctr  = new int       [nchannels];
-  chan_write_ctr = new int       [nchannels];
-  chan_mapsnrmax = new double    [nchannels];
-  trig_ctr       = new int       [nchannels];
+  chan_ctr       = new int       [fChannels.size()];
+  chan_data_ctr  = new int       [fChannels.size()];
+  chan_cond_ctr  = new int       [fChannels.size()];
+  chan_proj_ctr  = new int       [fChannels.size()];
+  chan_write_ctr = new int       [fChannels.size()];
+  chan_mapsnrmax = new double    [fChannels.size()];
+  trig_ctr       = new int       [fChannels.size()];
+  RawVect        = new double*   [nchannels];
+  RawSize        = new int       [nchannels];
+  RawStart       = new int       [nchannels];
+  RawEnd         = new int       [nchannels];
+  BatchVect      = new double*   [nchannels];
+  BatchSize      = new int       [nchannels];
+  BatchStart     = 0;
+  BatchEnd       = 0;
   for(int c=0; c<nchannels; c++){
+    BatchVect[c]      = NULL;
+    BatchSize[c]      = 0;
+    RawVect[c]        = NULL;
+    RawSize[c]        = 0;
+    RawStart[c]       = 0;
+    RawEnd[c]         = 0;
+  }
+  for(int c=0; c<(int)fChannels.size(); c++){
     outSegments[c]    = new Segments();
     chan_ctr[c]       = 0;
     chan_data_ctr[c]  = 0;
@@ -176,7 +259,14 @@ Omicron::Omicron(const string aOptionFile, const int aGpsRef, const bool aStrict
 Omicron::~Omicron(void){
 ////////////////////////////////////////////////////////////////////////////////////
   if(fVerbosity>1) cout<<"Omicron::~Omicron"<<endl;
-  if(status_OK&&fOutProducts.find("html")!=string::npos) MakeHtml(); // print final html report
+
+  // print final html report (ROOT output)
+  if(status_OK&&!changroup&&fOutProducts.find("html")!=string::npos){
+    lock_guard<mutex> wlock(omicron_write_mtx);
+    MakeHtml();
+  }
+
+  delete prefetch;// before the ffl objects
   delete inSegments;
   delete chan_ctr;
   delete chan_data_ctr;
@@ -185,13 +275,36 @@ Omicron::~Omicron(void){
   delete chan_write_ctr;
   delete chan_mapsnrmax;
   delete trig_ctr;
+  for(int c=0; c<(int)fChannels.size(); c++) delete outSegments[c];
+  delete outSegments;
+  for(int d=0; d<(int)decimators.size(); d++) delete decimators[d];
+  decimators.clear();
+  delete oinj;
+  delete [] ChunkVect;
+  delete [] WorkVect;
+  delete arena;
+  delete [] WhiteVect_r;
+  delete [] WhiteVect_i;
+  for(int s=0; s<2*nchannels; s++) delete [] InvASD[s];
+  delete [] InvASD;
+  delete [] InvASDVersion;
+  delete [] SpecVersion;
+  delete [] PsdVect;
+  delete [] RawVect;
+  delete [] RawSize;
+  delete [] RawStart;
+  delete [] RawEnd;
+  delete [] BatchVect;
+  delete [] BatchSize;
+  delete TukeyWindow;
+
+  // ROOT objects and FFTW plans are destroyed one at a time
+  lock_guard<recursive_mutex> plock(OfftwPlannerMutex());
   for(int c=0; c<nchannels; c++){
-    delete outSegments[c];
     delete triggers[c];
     delete spectrum1[c];
     delete spectrum2[c];
   }
-  delete outSegments;
   delete spectrum1;
   delete spectrum2;
   delete spectrumw;
@@ -202,16 +315,15 @@ Omicron::~Omicron(void){
     for(int c=0; c<nchannels; c++) delete inject[c];
     delete inject;
   }
-  delete oinj;
   delete tile;
-  delete ChunkVect;
-  delete TukeyWindow;
   delete offt;
   
   if(fsginj) oinjfile.close();
   outdir.clear();
   chunkcenter.clear();
   chunktfile.clear();
+  fChannels.clear();
+  fChannelsConv.clear();
   fInjChan.clear();
   fInjFact.clear();
   fWindows.clear();
@@ -304,9 +416,11 @@ bool Omicron::MakeDirectories(const double aId){
   }
 
   // channel directories
+  // (only the directories of the group are created)
   outdir.clear();
-  for(int c=0; c<nchannels; c++){
-    outdir.push_back(maindir+"/"+triggers[c]->GetName());
+  for(int c=0; c<(int)fChannels.size(); c++){
+    outdir.push_back(maindir+"/"+fChannels[c]);
+    if(c%nchangroups!=changroup) continue;
     if(system(("mkdir -p "+outdir[c]).c_str())){
       cerr<<"Omicron::MakeDirectories: the output directory cannot be created"<<endl;
       return false;
@@ -346,9 +460,9 @@ bool Omicron::NewChunk(void){
   // save info for html report
   if(fOutProducts.find("html")!=string::npos) chunkcenter.push_back(tile->GetChunkTimeCenter());
 
-  // new segment --> reset PSD buffer
+  // new segment --> reset PSD buffer and raw data cache
   if(newseg)
-    for(int c=0; c<nchannels; c++){ spectrum1[c]->Reset(); spectrum2[c]->Reset(); }  
+    for(int c=0; c<nchannels; c++){ spectrum1[c]->Reset(); spectrum2[c]->Reset(); SpecVersion[2*c]++; SpecVersion[2*c+1]++; RawSize[c]=0; }  
 
   // generate SG parameters
   if(fsginj) oinj->MakeWaveform();
@@ -387,9 +501,9 @@ bool Omicron::DefineNewChunk(const int aTimeStart, const int aTimeEnd, const boo
   // save info for html report
   if(fOutProducts.find("html")!=string::npos) chunkcenter.push_back(tile->GetChunkTimeCenter());
 
-  // reset PSD buffer
+  // reset PSD buffer and raw data cache
   if(aResetPSDBuffer)
-    for(int c=0; c<nchannels; c++){ spectrum1[c]->Reset(); spectrum2[c]->Reset(); }
+    for(int c=0; c<nchannels; c++){ spectrum1[c]->Reset(); spectrum2[c]->Reset(); SpecVersion[2*c]++; SpecVersion[2*c+1]++; RawSize[c]=0; }
       
   chunk_ctr++;// one more chunk
   return true;
@@ -410,64 +524,131 @@ bool Omicron::NewChannel(void){
   // last channel
   if(chanindex==nchannels){
     chanindex=-1;
+    changlobal=-1;
     if(fVerbosity>1) cout<<"\t- no more channels to load"<<endl;
     return false; 
   }
 
   // new channel
+  changlobal=changroup+chanindex*nchangroups;
   if(fVerbosity>1) cout<<"\t- channel "<<triggers[chanindex]->GetName()<<" is loaded"<<endl;
-  chan_ctr[chanindex]++;
+  chan_ctr[changlobal]++;
 
   // reset number of tiles above threshold
-  trig_ctr[chanindex]=0;
+  trig_ctr[changlobal]=0;
   
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+bool Omicron::MergeChannelGroup(Omicron *aOmicron){
+////////////////////////////////////////////////////////////////////////////////////
+  if(!status_OK){
+    cerr<<"Omicron::MergeChannelGroup: the Omicron object is corrupted"<<endl;
+    return false;
+  }
+  if(aOmicron==NULL||!aOmicron->GetStatus()){
+    cerr<<"Omicron::MergeChannelGroup: the input Omicron object is corrupted"<<endl;
+    return false;
+  }
+  if(aOmicron->nchangroups!=nchangroups||aOmicron->changroup==changroup){
+    cerr<<"Omicron::MergeChannelGroup: the input Omicron object does not process another channel group"<<endl;
+    return false;
+  }
+  if(aOmicron->fChannels!=fChannels){
+    cerr<<"Omicron::MergeChannelGroup: the channel lists do not match"<<endl;
+    return false;
+  }
+
+  // copy the monitoring of the channels of the other group (global channel index)
+  for(int c=aOmicron->changroup; c<(int)fChannels.size(); c+=nchangroups){
+    chan_ctr[c]       = aOmicron->chan_ctr[c];
+    chan_data_ctr[c]  = aOmicron->chan_data_ctr[c];
+    chan_cond_ctr[c]  = aOmicron->chan_cond_ctr[c];
+    chan_proj_ctr[c]  = aOmicron->chan_proj_ctr[c];
+    chan_write_ctr[c] = aOmicron->chan_write_ctr[c];
+    chan_mapsnrmax[c] = aOmicron->chan_mapsnrmax[c];
+    trig_ctr[c]       = aOmicron->trig_ctr[c];
+    outSegments[c]->Reset();
+    outSegments[c]->AddSegments(aOmicron->outSegments[c]);
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 bool Omicron::LoadData(double **aDataVector, int *aSize){
 ////////////////////////////////////////////////////////////////////////////////////
+  if(!LoadDataBuffer(aDataVector, aSize)) return false;
+
+  // copy for the user
+  double *dvector = new double [*aSize];
+  memcpy(dvector, *aDataVector, (*aSize)*sizeof(double));
+  *aDataVector=dvector;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Omicron::LoadData(double *aDataVector, const int aCapacity, int *aSize){
+////////////////////////////////////////////////////////////////////////////////////
+  double *dvector;
+  if(!LoadDataBuffer(&dvector, aSize)) return false;
+
+  // copy in the user vector
+  if(aDataVector==NULL||*aSize>aCapacity){
+    cerr<<"Omicron::LoadData: the user vector is too small ("<<aCapacity<<" < "<<*aSize<<" samples)"<<endl;
+    return false;
+  }
+  memcpy(aDataVector, dvector, (*aSize)*sizeof(double));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Omicron::LoadDataBuffer(double **aDataVector, int *aSize){
+////////////////////////////////////////////////////////////////////////////////////
+  *aDataVector=NULL; *aSize=0;
   if(!status_OK){
-    cerr<<"Omicron::LoadData: the Omicron object is corrupted"<<endl;
-    aDataVector=NULL; *aSize=0;
+    cerr<<"Omicron::LoadDataBuffer: the Omicron object is corrupted"<<endl;
     return false;
   }
   if(FFL==NULL){
-    cerr<<"Omicron::LoadData: this function can only be used with a valid FFL object"<<endl;
-    aDataVector=NULL; *aSize=0;
+    cerr<<"Omicron::LoadDataBuffer: this function can only be used with a valid FFL object"<<endl;
     return false;
   }
   if(!tile->GetChunkTimeCenter()){
-    cerr<<"Omicron::LoadData: no chunk called yet"<<endl;
-    aDataVector=NULL; *aSize=0;
+    cerr<<"Omicron::LoadDataBuffer: no chunk called yet"<<endl;
     return false;
   }
   if(chanindex<0){
-    cerr<<"Omicron::LoadData: no channel called yet"<<endl;
-    aDataVector=NULL; *aSize=0;
+    cerr<<"Omicron::LoadDataBuffer: no channel called yet"<<endl;
     return false;
   }
 
   if(fVerbosity){
-    if(fInjChan.size()) cout<<"Omicron::LoadData: load data vector and add injections..."<<endl;
-    else cout<<"Omicron::LoadData: load data vector..."<<endl;
+    if(fInjChan.size()) cout<<"Omicron::LoadDataBuffer: load data vector and add injections..."<<endl;
+    else cout<<"Omicron::LoadDataBuffer: load data vector..."<<endl;
   }
 
   // get data vector
   if(fVerbosity>1) cout<<"\t- get data from frames..."<<endl;
-  *aDataVector = FFL->GetData(*aSize, triggers[chanindex]->GetName(), tile->GetChunkTimeStart(), tile->GetChunkTimeEnd());
+  int dsize;
+  bool owner;
+  if(fRawCache||tile->GetStride()) dsize = GetCachedData();
+  else{
+    double *dvector = ReadData(dsize, owner, FFL, triggers[chanindex]->GetName(), tile->GetChunkTimeStart(), tile->GetChunkTimeEnd());
+    if(dsize>0) SetDataBuffer(dsize, dvector, owner);
+  }
 
   // cannot retrieve data
-  if(*aSize<=0){
-    cerr<<"Omicron::LoadData: cannot retrieve data ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
-    aDataVector=NULL; *aSize=0;
+  if(dsize<=0){
+    cerr<<"Omicron::LoadDataBuffer: cannot retrieve data ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
     return false;
   }
 
   // test native sampling (and update if necessary)
-  int nativesampling = *aSize/(tile->GetTimeRange());
+  int nativesampling = dsize/(tile->GetTimeRange());
   if(!triggers[chanindex]->SetNativeFrequency(nativesampling)){
-    cerr<<"Omicron::LoadData: incompatible native/working frequency ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
+    cerr<<"Omicron::LoadDataBuffer: incompatible native/working frequency ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
     return false;
   }
 
@@ -475,8 +656,8 @@ bool Omicron::LoadData(double **aDataVector, int *aSize){
   if(inject!=NULL){
     if(fVerbosity>1) cout<<"\t- perform software injections..."<<endl;
     inject[chanindex]->UpdateNativeSamplingFrequency();
-    if(!inject[chanindex]->Inject(*aSize, *aDataVector, tile->GetChunkTimeStart())){
-      cerr<<"Omicron::LoadData: failed to inject ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
+    if(!inject[chanindex]->Inject(dsize, DataVect, tile->GetChunkTimeStart())){
+      cerr<<"Omicron::LoadDataBuffer: failed to inject ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
       return false;
     }
   }
@@ -485,38 +666,268 @@ bool Omicron::LoadData(double **aDataVector, int *aSize){
   if(fInjChan.size()){
     if(fVerbosity>1) cout<<"\t- perform stream injections..."<<endl;
     int dsize_inj;
-    double *dvector_inj = FFL_inject->GetData(dsize_inj, fInjChan[chanindex], tile->GetChunkTimeStart(), tile->GetChunkTimeEnd());
+    double *dvector_inj = ReadData(dsize_inj, owner, FFL_inject, fInjChan[changlobal], tile->GetChunkTimeStart(), tile->GetChunkTimeEnd());
 
     // cannot retrieve data
     if(dsize_inj<=0){
-      cerr<<"Omicron::LoadData: cannot retrieve injection data ("<<fInjChan[chanindex]<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
-      delete aDataVector; aDataVector=NULL; *aSize=0;
+      cerr<<"Omicron::LoadDataBuffer: cannot retrieve injection data ("<<fInjChan[changlobal]<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
       return false;
     }
 
     // size mismatch
-    if(dsize_inj!=*aSize){
-      cerr<<"Omicron::LoadData: the sampling of the injection channel is not the same as the sampling of the main channel ("<<fInjChan[chanindex]<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
-      delete aDataVector; aDataVector=NULL; *aSize=0;
-      delete dvector_inj;
+    if(dsize_inj!=dsize){
+      cerr<<"Omicron::LoadDataBuffer: the sampling of the injection channel is not the same as the sampling of the main channel ("<<fInjChan[changlobal]<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
+      if(owner) delete [] dvector_inj;
       return false;
     }
 
     // add injections in the data
-    for(int d=0; d<*aSize; d++) (*aDataVector)[d]+=(fInjFact[chanindex]*dvector_inj[d]);
-    delete dvector_inj;
+    for(int d=0; d<dsize; d++) DataVect[d]+=(fInjFact[changlobal]*dvector_inj[d]);
+    if(owner) delete [] dvector_inj;
   }
 
+  // read the next data in the background
+  Prefetch();
+
   // add sg injections
   // FIXME: could be moved in Condition()
   if(fsginj){
-    for(int d=0; d<*aSize; d++) (*aDataVector)[d]+=oinj->GetWaveform(d,nativesampling);
+    for(int d=0; d<dsize; d++) DataVect[d]+=oinj->GetWaveform(d,nativesampling);
   }
 
-  chan_data_ctr[chanindex]++;
+  *aDataVector=DataVect; *aSize=dsize;
+  chan_data_ctr[changlobal]++;
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+double* Omicron::GetDataBuffer(const int aSize){
+////////////////////////////////////////////////////////////////////////////////////
+  // re-allocated only if the size increases
+  DataVect=arena->Get(0, aSize);
+  return DataVect;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Omicron::SetDataBuffer(const int aSize, double *aDataVector, const bool aOwner){
+////////////////////////////////////////////////////////////////////////////////////
+  memcpy(GetDataBuffer(aSize), aDataVector, aSize*sizeof(double));
+  if(aOwner) delete [] aDataVector;
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+double* Omicron::ReadData(int &aSize, bool &aOwner, ffl *aFfl, const string aChannel, const int aStart, const int aEnd){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // batch read: all the channels are read at once
+  // the vector belongs to the arena: it is valid until the next batch
+  aOwner=false;
+  if(fBatchRead&&aFfl==FFL&&chanindex>=0&&!aChannel.compare(triggers[chanindex]->GetName())){
+    if(aStart!=BatchStart||aEnd!=BatchEnd) ReadBatch(aStart, aEnd);
+    if(BatchSize[chanindex]>0){
+      aSize = BatchSize[chanindex];
+      return BatchVect[chanindex];
+    }
+    // not available --> read this channel only
+  }
+
+  // new vector
+  aOwner=true;
+
+  if(prefetch!=NULL) return prefetch->GetData(aSize, aFfl, aChannel, aStart, aEnd);
+
+  omicron_read_mtx.lock();
+  double *dvector = aFfl->GetData(aSize, aChannel, aStart, aEnd);
+  omicron_read_mtx.unlock();
+  return dvector;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Omicron::ReadBatch(const int aStart, const int aEnd){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // remove previous batch
+  // the vectors are kept in the arena: they are re-used for this batch
+  for(int c=0; c<nchannels; c++) BatchSize[c]=0;
+  BatchStart=aStart;
+  BatchEnd=aEnd;
+
+  if(fVerbosity>1) cout<<"\t- read all channels "<<aStart<<"-"<<aEnd<<" in one pass..."<<endl;
+  lock_guard<mutex> lock(omicron_read_mtx);
+
+  // loop over frame files: each file is opened once
+  // a failed channel is flagged with BatchSize=-1
+  FrFile *frfile;
+  FrVect *frvect;
+  double fstart, fend;
+  int sampling, offset;
+  double covered=0.0;
+  for(unsigned int f=0; f<FFL->GetNFrameFiles(); f++){
+    fstart = TMath::Max(FFL->GetFrameFileStart(f), (double)aStart);
+    fend   = TMath::Min(FFL->GetFrameFileStart(f)+FFL->GetFrameFileDuration(f), (double)aEnd);
+    if(fend<=fstart) continue;
+
+    frfile = FrFileINew((char*)FFL->GetFrameFileName(f).c_str());
+    if(frfile==NULL){
+      cerr<<"Omicron::ReadBatch: cannot open "<<FFL->GetFrameFileName(f)<<endl;
+      for(int c=0; c<nchannels; c++) BatchSize[c]=-1;
+      break;
+    }
+    covered+=fend-fstart;
+
+    for(int c=0; c<nchannels; c++){
+      if(BatchSize[c]<0) continue;
+
+      // read channel data (double precision)
+      frvect = FrFileIGetVectD(frfile, (char*)triggers[c]->GetName().c_str(), fstart, fend-fstart);
+      if(frvect==NULL||frvect->nData<=0){
+        BatchSize[c]=-1;
+        if(frvect!=NULL) FrVectFree(frvect);
+        continue;
+      }
+
+      // chunk vector with the first file (re-allocated only if the size increases)
+      sampling = (int)round((double)frvect->nData/(fend-fstart));
+      if(!BatchSize[c]){
+        BatchSize[c] = sampling*(aEnd-aStart);
+        BatchVect[c] = arena->Get(1+c, BatchSize[c]);
+      }
+      offset = (int)round((fstart-(double)aStart)*(double)sampling);
+      if(BatchSize[c]!=sampling*(aEnd-aStart)||offset+frvect->nData>BatchSize[c]) BatchSize[c]=-1;
+      else memcpy(BatchVect[c]+offset, frvect->dataD, frvect->nData*sizeof(double));
+      FrVectFree(frvect);
+    }
+
+    FrFileIEnd(frfile);
+  }
+
+  // the frame files must cover the full chunk
+  // failed channels are read individually
+  for(int c=0; c<nchannels; c++){
+    if(BatchSize[c]<0||covered<(double)(aEnd-aStart)) BatchSize[c]=0;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Omicron::Prefetch(void){
+////////////////////////////////////////////////////////////////////////////////////
+  if(prefetch==NULL) return;
+
+  // chunks: current + next ones
+  vector <int> starts, ends;
+  int nchunks = prefetch->GetDepth()/nchannels + 1;
+  tile->GetNextChunks(nchunks, starts, ends);
+  starts.insert(starts.begin(), tile->GetChunkTimeStart());
+  ends.insert(ends.begin(), tile->GetChunkTimeEnd());
+
+  // request the data in the processing order: next channels of the current chunk first
+  int start;
+  for(int k=0; k<(int)starts.size(); k++){
+    for(int c=(k?0:chanindex+1); c<nchannels; c++){
+
+      // streaming: only the new data are read
+      start=starts[k];
+      if(fRawCache||tile->GetStride()){
+        if(!k){
+          if(RawSize[c]&&RawStart[c]<=start&&start<RawEnd[c]&&RawEnd[c]<ends[k]) start=RawEnd[c];
+        }
+        else if(starts[k-1]<=start&&start<ends[k-1]&&ends[k-1]<ends[k]) start=ends[k-1];
+      }
+
+      if(!fBatchRead&&!prefetch->Request(FFL, triggers[c]->GetName(), start, ends[k])) return;
+      if(fInjChan.size()&&!prefetch->Request(FFL_inject, fInjChan[changroup+c*nchangroups], starts[k], ends[k])) return;
+    }
+  }
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+int Omicron::GetCachedData(void){
+////////////////////////////////////////////////////////////////////////////////////
+  int c=chanindex;
+  int start=tile->GetChunkTimeStart();
+  int end=tile->GetChunkTimeEnd();
+  int size=0;
+
+  // the cached data overlap the current chunk: only the new data are read
+  if(RawSize[c]&&RawStart[c]<=start&&start<RawEnd[c]&&RawEnd[c]<end&&RawEnd[c]-RawStart[c]==end-start){
+    int sampling=RawSize[c]/(RawEnd[c]-RawStart[c]);
+    int nnew;
+    bool owner;
+    double *dnew = ReadData(nnew, owner, FFL, triggers[c]->GetName(), RawEnd[c], end);
+    if(nnew==(end-RawEnd[c])*sampling){
+      if(fVerbosity>1) cout<<"\t- re-use "<<RawEnd[c]-start<<"s of data from the last chunk"<<endl;
+
+      // the new data replace the oldest data in the ring
+      RawCopy((long int)RawEnd[c]*(long int)sampling, nnew, dnew, true);
+      RawStart[c]=start;
+      RawEnd[c]=end;
+      size=RawSize[c];
+      GetDataBuffer(size);
+      RawCopy((long int)start*(long int)sampling, size, DataVect, false);
+    }
+    if(nnew>0&&owner) delete [] dnew;
+  }
+  if(size) return size;
+
+  // read the full chunk
+  bool owner;
+  double *dvector = ReadData(size, owner, FFL, triggers[c]->GetName(), start, end);
+  if(size<=0){
+    RawSize[c]=0;
+    return 0;
+  }
+  SetDataBuffer(size, dvector, owner);
+
+  // cache the raw data for the next chunk (before injections)
+  // the ring is re-allocated only if the size increases
+  RawVect[c]=arena->Get(1+nchannels+c, size);
+  RawSize[c]=size;
+  RawStart[c]=start;
+  RawEnd[c]=end;
+  RawCopy((long int)start*(long int)(size/(end-start)), size, DataVect, true);
+
+  return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Omicron::RawCopy(const long int aSample, const int aSize, double *aData, const bool aToCache){
+////////////////////////////////////////////////////////////////////////////////////
+  double *ring=RawVect[chanindex];
+  int ringsize=RawSize[chanindex];
+
+  // position in the ring (GPS-indexed)
+  int r = (int)(aSample%(long int)ringsize);
+  int n1 = TMath::Min(aSize, ringsize-r);
+
+  if(aToCache){
+    memcpy(ring+r, aData, n1*sizeof(double));
+    memcpy(ring, aData+n1, (aSize-n1)*sizeof(double));
+  }
+  else{
+    memcpy(aData, ring+r, n1*sizeof(double));
+    memcpy(aData+n1, ring, (aSize-n1)*sizeof(double));
+  }
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Odecimator* Omicron::GetDecimator(const int aNativeFrequency){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // the filter is designed once per native frequency
+  for(int d=0; d<(int)decimators.size(); d++)
+    if(decimators[d]->GetNativeFrequency()==aNativeFrequency) return decimators[d];
+
+  if(fVerbosity>1) cout<<"\t- design polyphase decimator "<<aNativeFrequency<<" Hz --> "<<triggers[0]->GetWorkingFrequency()<<" Hz"<<endl;
+  decimators.push_back(new Odecimator(aNativeFrequency, triggers[0]->GetWorkingFrequency()));
+  return decimators.back();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 int Omicron::Condition(const int aInVectSize, double *aInVect){
 ////////////////////////////////////////////////////////////////////////////////////
@@ -548,17 +959,23 @@ int Omicron::Condition(const int aInVectSize, double *aInVect){
 
   // transform data vector
   if(fVerbosity>1) cout<<"\t- transform data vector..."<<endl;
-  if(!triggers[chanindex]->Transform(aInVectSize, aInVect, offt->GetSize_t(), ChunkVect)) return 4;
+  if(fPolyphase&&nativesampling>triggers[chanindex]->GetWorkingFrequency()&&triggers[chanindex]->GetHighPassFrequency()<=0.0){
+    if(!GetDecimator(nativesampling)->Decimate(aInVectSize, aInVect, ChunkVect)) return 4;
+  }
+  else if(!triggers[chanindex]->Transform(aInVectSize, aInVect, offt->GetSize_t(), ChunkVect)) return 4;
 
-  // apply Tukey Window
+  // apply Tukey Window (only the edges: 1 in between)
   if(fVerbosity>1) cout<<"\t- apply Tukey window..."<<endl;
-  for(int i=0; i<offt->GetSize_t(); i++) ChunkVect[i] *= TukeyWindow[i];
+  int tukeyedge = tile->GetOverlapDuration()*triggers[chanindex]->GetWorkingFrequency()/2;
+  for(int i=0; i<tukeyedge; i++) ChunkVect[i] *= TukeyWindow[i];
+  for(int i=offt->GetSize_t()-tukeyedge; i<offt->GetSize_t(); i++) ChunkVect[i] *= TukeyWindow[i];
 
   // update first spectrum (if enough data)
   if(fVerbosity>1) cout<<"\t- update spectrum 1..."<<endl;
   int dstart = (tile->GetCurrentOverlapDuration()-tile->GetOverlapDuration()/2)*triggers[chanindex]->GetWorkingFrequency(); // start of 'sane' data
   int dsize = (tile->GetTimeRange()-tile->GetCurrentOverlapDuration())*triggers[chanindex]->GetWorkingFrequency(); // size of 'sane' data
-  if(!spectrum1[chanindex]->AddData(dsize, ChunkVect, dstart))
+  if(spectrum1[chanindex]->AddData(dsize, ChunkVect, dstart)) SpecVersion[2*chanindex]++;
+  else
      cerr<<"Omicron::Condition: warning: this chunk is not used for PSD(1) estimation ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
   if(spectrum1[chanindex]->IsBufferEmpty()){
     cerr<<"Omicron::Condition: No PSD is available ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
@@ -569,41 +986,29 @@ int Omicron::Condition(const int aInVectSize, double *aInVect){
   if(fVerbosity>1) cout<<"\t- move the data in the frequency domain..."<<endl;
   if(!offt->Forward(ChunkVect)) return 6;
 
-  // 1st whitening
+  // 1st whitening (+ FFT backward normalization)
+  // a copy of the whitened data is kept: the backward fft (c2r) destroys the frequency-domain vector
   if(fVerbosity>1) cout<<"\t- whiten chunk (1)"<<endl;
-  Whiten(spectrum1[chanindex]);
+  Whiten(GetInverseASD(0), false);
 
   // back in the time domain
   if(fVerbosity>1) cout<<"\t- move the data back in the time domain..."<<endl;
   offt->Backward();
 
-  // apply FFT (forward and backward) normalization
-  for(int i=0; i<offt->GetSize_t(); i++) offt->SetRe_t(i, offt->GetRe_t(i)/(double)offt->GetSize_t());
-
   // update second spectrum
   if(fVerbosity>1) cout<<"\t- update spectrum 2..."<<endl;
-  double *rvec = offt->GetRe_t();
-  if(!spectrum2[chanindex]->AddData(dsize, rvec, dstart))
+  for(int i=0; i<offt->GetSize_t(); i++) WorkVect[i]=offt->GetRe_t(i);
+  if(spectrum2[chanindex]->AddData(dsize, WorkVect, dstart)) SpecVersion[2*chanindex+1]++;
+  else
     cerr<<"Omicron::Condition: warning: this chunk is not used for PSD(2) estimation ("<<triggers[chanindex]->GetName()<<" "<<tile->GetChunkTimeStart()<<"-"<<tile->GetChunkTimeEnd()<<")"<<endl;
   if(spectrum2[chanindex]->IsBufferEmpty()){// should never happen if it worked for the 1st spectrum
-    delete rvec;
     return 7;
   }
-  delete rvec;
   
-  // fft-forward the chunk data
-  if(fVerbosity>1) cout<<"\t- move the data in the frequency domain..."<<endl;
-  offt->Forward();// This is mandatory because the frequency-domain vector was messed-up by the previous backward (r2c)
-
-  // apply FFT (forward) normalization
-  for(int i=0; i<offt->GetSize_f(); i++){
-    offt->SetRe_f(i, offt->GetRe_f(i)/(double)triggers[chanindex]->GetWorkingFrequency());
-    offt->SetIm_f(i, offt->GetIm_f(i)/(double)triggers[chanindex]->GetWorkingFrequency());
-  }
-
-  // 2nd whitening
+  // 2nd whitening (+ FFT forward normalization)
+  // the whitened data are restored in the frequency domain: no need to fft-forward the time-domain vector again
   if(fVerbosity>1) cout<<"\t- whiten chunk (2)"<<endl;
-  Whiten(spectrum2[chanindex]);
+  Whiten(GetInverseASD(1), true);
 
   // compute tiling power
   if(fVerbosity>1) cout<<"\t- compute tiling power..."<<endl;
@@ -613,7 +1018,7 @@ int Omicron::Condition(const int aInVectSize, double *aInVect){
   // must be done here because the spectra are needed
   if(fsginj) SaveSG();
 
-  chan_cond_ctr[chanindex]++;
+  chan_cond_ctr[changlobal]++;
   return 0;
 }
 
@@ -626,9 +1031,19 @@ int Omicron::Project(void){
   }
 
   if(fVerbosity) cout<<"Omicron::Project: project data onto the tiles..."<<endl;
-  chan_proj_ctr[chanindex]++;
-  trig_ctr[chanindex]=tile->ProjectData(offt);
-  return trig_ctr[chanindex];
+  chan_proj_ctr[changlobal]++;
+
+  // no triggers: only the tiles in the largest map window are needed
+  if(fOutProducts.find("triggers")==string::npos)
+    tile->SetProjectionWindow(toffset-(double)fWindows.back()/2.0, toffset+(double)fWindows.back()/2.0);
+
+  // streaming: the chunk output is projected (see Otile::NewChunk()), add the map window
+  else if(tile->GetStride()&&fOutProducts.find("map")!=string::npos)
+    tile->SetProjectionWindow(TMath::Min((double)tile->GetChunkOutputStart(), toffset-(double)fWindows.back()/2.0),
+                              TMath::Max((double)tile->GetChunkOutputEnd(), toffset+(double)fWindows.back()/2.0));
+
+  trig_ctr[changlobal]=tile->ProjectData(offt);
+  return trig_ctr[changlobal];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -639,6 +1054,9 @@ bool Omicron::WriteOutput(void){
     return false;
   }
   if(fVerbosity) cout<<"Omicron::WriteOutput: write chunk output..."<<endl;
+
+  // one channel group at a time (ROOT output)
+  lock_guard<mutex> lock(omicron_write_mtx);
  
   //*** ASD
   if(fOutProducts.find("asd")!=string::npos){
@@ -663,14 +1081,15 @@ bool Omicron::WriteOutput(void){
     if(fVerbosity>1) cout<<"\t- write whitened data..."<<endl;
     offt->Backward();// Back in time domain
     // IMPORTANT: after that, the frequency-domain vector of offt is corrupted (r2c)
-    // apply FFT normalization
-    for(int i=0; i<offt->GetSize_t(); i++) offt->SetRe_t(i, offt->GetRe_t(i)*triggers[chanindex]->GetWorkingFrequency()/(double)offt->GetSize_t());
+    // the FFT normalization is applied when reading the time-domain vector
     SaveTS(true);
 
     if(fOutProducts.find("whitepsd")!=string::npos){
       int dstart = (tile->GetCurrentOverlapDuration()-tile->GetOverlapDuration()/2)*triggers[chanindex]->GetWorkingFrequency(); // start of 'sane' data
       int dsize = (tile->GetTimeRange()-tile->GetCurrentOverlapDuration())*triggers[chanindex]->GetWorkingFrequency(); // size of 'sane' data
-      if(spectrumw->LoadData(dsize, offt->GetRe_t(), dstart)) SaveWPSD();
+      double norm = (double)triggers[chanindex]->GetWorkingFrequency()/(double)offt->GetSize_t();// FFT normalization
+      for(int i=0; i<offt->GetSize_t(); i++) WorkVect[i]=offt->GetRe_t(i)*norm;
+      if(spectrumw->LoadData(dsize, WorkVect, dstart)) SaveWPSD();
     }
   }
   
@@ -678,10 +1097,10 @@ bool Omicron::WriteOutput(void){
   if(fOutProducts.find("map")!=string::npos){
     double snr;// snr max of the full map
     if(fVerbosity>1) cout<<"\t- write maps"<<endl;
-    snr=tile->SaveMaps(outdir[chanindex],
+    snr=tile->SaveMaps(outdir[changlobal],
 		       triggers[chanindex]->GetNameConv()+"_OMICRON",
 		       fOutFormat,fWindows,toffset,(bool)(fOutProducts.find("html")+1));
-    if(snr>chan_mapsnrmax[chanindex]) chan_mapsnrmax[chanindex]=snr;// get snr max over all chunks
+    if(snr>chan_mapsnrmax[changlobal]) chan_mapsnrmax[changlobal]=snr;// get snr max over all chunks
   }
 
   //*** TRIGGERS
@@ -696,12 +1115,93 @@ bool Omicron::WriteOutput(void){
 
   // update monitoring segments
   // -- do not include output segment selection --
-  outSegments[chanindex]->AddSegment((double)(tile->GetChunkTimeStart()+tile->GetCurrentOverlapDuration()-tile->GetOverlapDuration()/2),(double)(tile->GetChunkTimeEnd()-tile->GetOverlapDuration()/2));
+  outSegments[changlobal]->AddSegment((double)(tile->GetChunkTimeStart()+tile->GetCurrentOverlapDuration()-tile->GetOverlapDuration()/2),(double)(tile->GetChunkTimeEnd()-tile->GetOverlapDuration()/2));
 
-  chan_write_ctr[chanindex]++;
+  chan_write_ctr[changlobal]++;
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+int Omicron::InjectCampaign(void){
+////////////////////////////////////////////////////////////////////////////////////
+  if(!status_OK){
+    cerr<<"Omicron::InjectCampaign: the Omicron object is corrupted"<<endl;
+    return -1;
+  }
+  if(fSgCampaign<=0) return 0;
+
+  if(fVerbosity) cout<<"Omicron::InjectCampaign: inject "<<fSgCampaign<<" sine-Gaussian waveforms..."<<endl;
+
+  // output table
+  ofstream campfile((outdir[changlobal]+"/"+triggers[chanindex]->GetNameConv()+"_OMICRONSGCAMPAIGN.txt").c_str(), ios::app);
+  if(!campfile.is_open()){
+    cerr<<"Omicron::InjectCampaign: cannot open the output file ("<<triggers[chanindex]->GetName()<<")"<<endl;
+    return -1;
+  }
+  campfile.seekp(0, ios::end);
+  if(campfile.tellp()==0) campfile<<"# Time # Frequency # Q # Amplitude # Phase # True SNR # Recovered SNR # Recovered time # Recovered frequency"<<endl;
+  campfile.precision(5);
+
+  // whitening: the 1st whitened noise is saved in WhiteVect
+  double *invasd1 = GetInverseASD(0);
+  double *invasd2 = GetInverseASD(1);
+  double timerange = (double)tile->GetTimeRange();
+  double sampling = (double)triggers[chanindex]->GetWorkingFrequency();
+  
+  int kmin, kmax, kmin_prev=1, kmax_prev=0;
+  double re, im, win, snr, t, f;
+  for(int n=0; n<fSgCampaign; n++){
+    oinj->MakeWaveform();
+
+    // restore the whitened noise (previous waveform)
+    for(int k=kmin_prev; k<=kmax_prev; k++){
+      offt->SetRe_f(k,WhiteVect_r[k]*invasd2[k]);
+      offt->SetIm_f(k,WhiteVect_i[k]*invasd2[k]);
+    }
+
+    // add the whitened waveform over its frequency support
+    // (FFT normalization: continuous Fourier transform x sampling frequency)
+    kmin = TMath::Max(1,(int)floor((oinj->GetFrequency()-SGCAMPAIGN_NSIGMA*oinj->GetSigmaf())*timerange));
+    kmax = TMath::Min(offt->GetSize_f()-1,(int)ceil((oinj->GetFrequency()+SGCAMPAIGN_NSIGMA*oinj->GetSigmaf())*timerange));
+    for(int k=kmin; k<=kmax; k++){
+      oinj->GetWaveformFT((double)k/timerange, re, im);
+      offt->SetRe_f(k,(WhiteVect_r[k]+re*sampling*invasd1[k])*invasd2[k]);
+      offt->SetIm_f(k,(WhiteVect_i[k]+im*sampling*invasd1[k])*invasd2[k]);
+    }
+    kmin_prev=kmin;
+    kmax_prev=kmax;
+
+    // project the data around the injection
+    win = SGCAMPAIGN_NSIGMA*oinj->GetSigmat();
+    tile->SetProjectionWindow(oinj->GetTime()-win, oinj->GetTime()+win);
+    tile->ProjectData(offt);
+    snr = tile->GetSNRMax(oinj->GetTime()-win, oinj->GetTime()+win, t, f);
+
+    campfile<<fixed<<(double)tile->GetChunkTimeCenter()+oinj->GetTime()<<" ";
+    campfile<<fixed<<oinj->GetFrequency()<<" ";
+    campfile<<fixed<<oinj->GetQ()<<" ";
+    campfile<<scientific<<oinj->GetAmplitude()<<" ";
+    campfile<<fixed<<oinj->GetPhase()<<" ";
+    campfile<<fixed<<oinj->GetTrueSNR(spectrum1[chanindex], spectrum2[chanindex])<<" ";
+    campfile<<fixed<<snr<<" ";
+    campfile<<fixed<<(double)tile->GetChunkTimeCenter()+t<<" ";
+    campfile<<fixed<<f<<endl;
+  }
+  campfile.close();
+
+  // restore the whitened noise
+  for(int k=kmin_prev; k<=kmax_prev; k++){
+    offt->SetRe_f(k,WhiteVect_r[k]*invasd2[k]);
+    offt->SetIm_f(k,WhiteVect_i[k]*invasd2[k]);
+  }
+
+  // restore the projection window
+  if(tile->GetStride()) tile->SetProjectionWindow((double)tile->GetChunkOutputStart(), (double)tile->GetChunkOutputEnd());
+  else tile->SetProjectionWindow(-timerange/2.0, timerange/2.0);
+
+  return fSgCampaign;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 bool Omicron::ExtractTriggers(void){
 ////////////////////////////////////////////////////////////////////////////////////
@@ -711,7 +1211,7 @@ bool Omicron::ExtractTriggers(void){
   }
 
   // trigger rate: evaluated over the chunk excluding nominal overlaps/2
-  double trate = (double)trig_ctr[chanindex]/(double)(tile->GetTimeRange()-tile->GetOverlapDuration());
+  double trate = (double)trig_ctr[changlobal]/(double)(tile->GetTimeRange()-tile->GetOverlapDuration());
 
   // check against trigger rate limit
   if(trate>fratemax){
@@ -760,41 +1260,85 @@ string Omicron::WriteTriggers(const bool aLVDirConvention){
   }
   
   // write triggers to disk
-  return triggers[chanindex]->Write(outdir[chanindex],fOutFormat);
+  return triggers[chanindex]->Write(outdir[changlobal],fOutFormat);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Omicron::Whiten(const double *aInvASD, const bool aFromCopy){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // whiten the copy of the whitened data
+  if(aFromCopy){
+    for(int i=0; i<offt->GetSize_f(); i++){
+      offt->SetRe_f(i,WhiteVect_r[i] * aInvASD[i]);
+      offt->SetIm_f(i,WhiteVect_i[i] * aInvASD[i]);
+    }
+    return;
+  }
+
+  // whiten the data and keep a copy
+  for(int i=0; i<offt->GetSize_f(); i++){
+    WhiteVect_r[i]=offt->GetRe_f(i) * aInvASD[i];
+    WhiteVect_i[i]=offt->GetIm_f(i) * aInvASD[i];
+    offt->SetRe_f(i,WhiteVect_r[i]);
+    offt->SetIm_f(i,WhiteVect_i[i]);
+  }
+  return;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
-void Omicron::Whiten(Spectrum *aSpec){
+double* Omicron::GetInverseASD(const int aSpecIndex){
 ////////////////////////////////////////////////////////////////////////////////////
+  int s=2*chanindex+aSpecIndex;
+
+  // the PSD did not change
+  if(InvASDVersion[s]==SpecVersion[s]) return InvASD[s];
+
+  if(InvASD[s]==NULL) InvASD[s] = new double [offt->GetSize_f()];
+  Spectrum *spec = aSpecIndex? spectrum2[chanindex] : spectrum1[chanindex];
 
   int i=0; // frequency index
  
   // zero-out DC
-  offt->SetRe_f(i,0.0);
-  offt->SetIm_f(i,0.0);
+  InvASD[s][i]=0.0;
   i++;
   
   // zero-out below highpass frequency
   int n = (int)(triggers[chanindex]->GetHighPassFrequency()*tile->GetTimeRange());
-  for(; i<n; i++){
-    offt->SetRe_f(i,0.0);
-    offt->SetIm_f(i,0.0);
-  }
+  for(; i<n; i++) InvASD[s][i]=0.0;
  
+  // FFT normalizations are included:
+  // - 1st whitening: backward (1/N)
+  // - 2nd whitening: forward (1/fs) after the backward normalization is removed (N)
+  double norm;
+  if(aSpecIndex) norm = (double)offt->GetSize_t()/(double)triggers[chanindex]->GetWorkingFrequency();
+  else norm = 1.0/(double)offt->GetSize_t();
+
+  // sample the PSD on its own frequency bins (no interpolation)
+  int m = (int)spec->GetSpectrumSize();
+  if(m>PsdSize){
+    delete [] PsdVect;
+    PsdVect = new double [m];
+    PsdSize = m;
+  }
+  for(int j=0; j<m; j++) PsdVect[j]=spec->GetPower(spec->GetSpectrumFrequency(j));
+
   // normalize data by the ASD
-  double asdval;
+  // the PSD is linearly interpolated on the chunk frequency grid (as in the Spectrum class)
+  double r = 1.0/(double)tile->GetTimeRange()/spec->GetSpectrumResolution();// chunk bin -> PSD bin
+  double x, a, psdval;
+  int j;
   for(; i<offt->GetSize_f(); i++){
-    asdval=aSpec->GetAmplitude((double)i/(double)tile->GetTimeRange())/sqrt(2.0);
-    if(!asdval){
-      offt->SetRe_f(i,0.0);
-      offt->SetIm_f(i,0.0);
-      continue;
-    }
-    offt->SetRe_f(i,offt->GetRe_f(i) / asdval);
-    offt->SetIm_f(i,offt->GetIm_f(i) / asdval);
+    x=(double)i*r;
+    j=(int)x;
+    if(j>=m-1){ j=m-2; a=1.0; }
+    else a=x-(double)j;
+    psdval=(1.0-a)*PsdVect[j]+a*PsdVect[j+1];
+    InvASD[s][i] = psdval>0.0 ? norm*sqrt(2.0/psdval) : 0.0;
   }
 
-  return;
+  InvASDVersion[s]=SpecVersion[s];
+  return InvASD[s];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -897,7 +1441,7 @@ void Omicron::SaveAPSD(const string aType){
   // ROOT
   if(fOutFormat.find("root")!=string::npos){
     TFile *fpsd;
-    ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRON"<<aType<<"-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
+    ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRON"<<aType<<"-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
     fpsd=new TFile((ss.str()).c_str(),"RECREATE");
     ss.str(""); ss.clear();
     fpsd->cd();
@@ -920,7 +1464,7 @@ void Omicron::SaveAPSD(const string aType){
   if(fOutFormat.find("svg")!=string::npos) form.push_back("svg"); 
   if(form.size()){
     for(int f=0; f<(int)form.size(); f++){
-      ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRON"<<aType<<"-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<"."<<form[f];
+      ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRON"<<aType<<"-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<"."<<form[f];
       tile->Print(ss.str().c_str());
       ss.str(""); ss.clear();
     }
@@ -974,7 +1518,7 @@ void Omicron::SaveWPSD(void){
   // ROOT
   if(fOutFormat.find("root")!=string::npos){
     TFile *fpsd;
-    ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWPSD-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
+    ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWPSD-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
     fpsd=new TFile((ss.str()).c_str(),"RECREATE");
     ss.str(""); ss.clear();
     fpsd->cd();
@@ -994,7 +1538,7 @@ void Omicron::SaveWPSD(void){
   if(fOutFormat.find("svg")!=string::npos) form.push_back("svg"); 
   if(form.size()){
     for(int f=0; f<(int)form.size(); f++){
-      ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWPSD-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<"."<<form[f];
+      ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWPSD-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<"."<<form[f];
       tile->Print(ss.str().c_str());
       ss.str(""); ss.clear();
     }
@@ -1035,7 +1579,7 @@ void Omicron::SaveSpectral(void){
   // ROOT
   if(fOutFormat.find("root")!=string::npos){
     TFile *fspec;
-    ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetName()<<"_"<<tile->GetChunkTimeCenter()<<"_spec.root";
+    ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetName()<<"_"<<tile->GetChunkTimeCenter()<<"_spec.root";
     fspec=new TFile((ss.str()).c_str(),"RECREATE");
     ss.str(""); ss.clear();
     fspec->cd();
@@ -1064,7 +1608,7 @@ void Omicron::SaveSpectral(void){
   // save
   if(form.size()){
     for(int f=0; f<(int)form.size(); f++){
-      ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetName()<<"_"<<tile->GetChunkTimeCenter()<<"_spec."<<form[f];
+      ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetName()<<"_"<<tile->GetChunkTimeCenter()<<"_spec."<<form[f];
       tile->Print(ss.str().c_str());
       ss.str(""); ss.clear();
     }
@@ -1089,7 +1633,8 @@ void Omicron::SaveTS(const bool aWhite){
   // whitened data
   if(aWhite){
     ss<<"whitets_"<<triggers[chanindex]->GetName()<<"_"<<tile->GetChunkTimeCenter();
-    for(int i=0; i<offt->GetSize_t(); i++) GDATA->SetPoint(i,(double)tile->GetChunkTimeStart()+(double)i/(double)(triggers[chanindex]->GetWorkingFrequency()),offt->GetRe_t(i));
+    double norm = (double)triggers[chanindex]->GetWorkingFrequency()/(double)offt->GetSize_t();// FFT normalization
+    for(int i=0; i<offt->GetSize_t(); i++) GDATA->SetPoint(i,(double)tile->GetChunkTimeStart()+(double)i/(double)(triggers[chanindex]->GetWorkingFrequency()),offt->GetRe_t(i)*norm);
   }
   // conditioned data
   else{
@@ -1125,9 +1670,9 @@ void Omicron::SaveTS(const bool aWhite){
   if(fOutFormat.find("root")!=string::npos){
     TFile *fdata;
     if(aWhite)
-      ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
+      ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
     else
-      ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
+      ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeStart()<<"-"<<tile->GetTimeRange()<<".root";
     fdata=new TFile((ss.str()).c_str(),"RECREATE");
     ss.str(""); ss.clear();
     fdata->cd();
@@ -1144,9 +1689,9 @@ void Omicron::SaveTS(const bool aWhite){
     // loop over windows
     for(int w=(int)fWindows.size()-1; w>=0; w--){
       if(aWhite)
-	ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<".wav";
+	ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<".wav";
       else
-	ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<".wav";
+	ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<".wav";
 
       // n samples
       int sound_nstart = TMath::Max(0,(int)(((double)tile->GetChunkTimeCenter()+toffset-(double)fWindows[w]/2.0-(double)tile->GetChunkTimeStart())*(double)triggers[chanindex]->GetWorkingFrequency()));
@@ -1179,16 +1724,16 @@ void Omicron::SaveTS(const bool aWhite){
       GDATA->GetXaxis()->SetLimits(tile->GetChunkTimeCenter()+toffset-(double)fWindows[w]/2.0,tile->GetChunkTimeCenter()+toffset+(double)fWindows[w]/2.0);
       for(int f=0; f<(int)form.size(); f++){
 	if(aWhite)
-	  ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
+	  ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
 	else
-	  ss<<outdir[chanindex]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
+	  ss<<outdir[changlobal]<<"/"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
 	tile->Print(ss.str().c_str());
 	ss.str(""); ss.clear();
 
 	if(aWhite)
-	  ss<<outdir[chanindex]<<"/th"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
+	  ss<<outdir[changlobal]<<"/th"+triggers[chanindex]->GetNameConv()<<"_OMICRONWHITETS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
 	else
-	  ss<<outdir[chanindex]<<"/th"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
+	  ss<<outdir[changlobal]<<"/th"+triggers[chanindex]->GetNameConv()<<"_OMICRONCONDTS-"<<tile->GetChunkTimeCenter()<<"-"<<fWindows[w]<<"."<<form[f];
 	tile->Print(ss.str().c_str(),0.5);
 	ss.str(""); ss.clear();
       }
@@ -14,6 +14,13 @@
 
 using namespace std;
 
+// sine-Gaussian injection campaign: waveform support [sigma]
+#define SGCAMPAIGN_NSIGMA 6.0
+
+class Oprefetch;
+class Odecimator;
+class Oarena;
+
 
 /**
  * Process data with the Omicron algorithm.
@@ -22,6 +29,13 @@ using namespace std;
  *
  * This class was designed to offer various methods to conduct an Omicron analysis.
  *
+ * Independent Omicron objects can be built and used concurrently in several threads of the same process. ROOT is initialized in thread-safe mode (ROOT::EnableThreadSafety()) when the first Omicron object is built. The non-thread-safe operations are serialized across all the Omicron objects of the process:
+ * - the creation and the destruction of FFT plans and ROOT objects, in particular when Omicron objects are built and destroyed (see OfftwPlannerMutex()),
+ * - the data reading from frame files (LoadData()),
+ * - the output writing (WriteOutput()).
+ *
+ * The conditioning and the projection of the data run concurrently. A given Omicron object must not be used by several threads at the same time.
+ *
  * \author Florent Robinet
  */
 class Omicron {
@@ -45,14 +59,16 @@ class Omicron {
    * - NewChannel() loads a new channel (loop #2).
    * - LoadData() loads the data vector for this chunk and this channel from FFL file (in loop #1/2)
    * - Condition() conditions data vector (in loop #1/2)
+   * - InjectCampaign() runs a sine-Gaussian injection campaign (optional, in loop #1/2)
    * - Project() projects data onto the tiles (in loop #1/2)
    * - WriteOutput() writes output data products to disk (in loop #1/2)
    *
    * @param aOptionFile path to the option file
    * @param aGpsRef Reference time to initiate structures (default).
    * @param aStrict strict mode when set to true: the status of the Omicron object is set to false if options are incorrectly provided.
+   * @param aChannelGroup channel group processed by this object, in [0, GetNChannelThreads()[. The channels are dealt to GetNChannelThreads() groups (round-robin): only the channels of this group are built and called by NewChannel(). This is used to process the channels in parallel with one Omicron object per group. The html report is only produced for the group 0: use MergeChannelGroup() to import the processing monitoring of the other groups. Use a negative value (default) to process all the channels.
    */
-  Omicron(const string aOptionFile, const int aGpsRef=-1, const bool aStrict=false);
+  Omicron(const string aOptionFile, const int aGpsRef=-1, const bool aStrict=false, const int aChannelGroup=-1);
   
   /**
    * Destructor of the Omicron class.
@@ -115,6 +131,19 @@ class Omicron {
    */
   bool NewChannel(void);
 
+  /**
+   * Imports the processing monitoring of another channel group.
+   * The monitoring counters and the output segments of the channels processed by another Omicron object (see Omicron()) are copied in this object. This way, the status info (see PrintStatusInfo()) and the html report cover all the channels. Both objects must be built with the same option file.
+   * @param aOmicron Omicron object processing another channel group
+   */
+  bool MergeChannelGroup(Omicron *aOmicron);
+
+  /**
+   * Returns the number of threads to process the channels in parallel.
+   * This is the number of channel groups, see Omicron().
+   */
+  inline int GetNChannelThreads(void){ return fChannelThreads; };
+
   /**
    * Returns the name of the current channel.
    * Returns "none" if no channel is defined.
@@ -124,7 +153,7 @@ class Omicron {
   /**
    * Loads a data vector.
    * The data vector of the current channel and the current chunk is loaded. If requested in the option file, the injection stream and the software injections are added to the data vector. This function loads the data from the frames listed in the FFL. The FFL option is therefore mandatory to use this function.
-   * It is the user's responsibility to delete the returned data vector.
+   * It is the user's responsibility to delete the returned data vector. A new vector is allocated for every call: use LoadDataBuffer() or LoadData(double*, const int, int*) to avoid the allocation.
    *
    * If this function fails, a pointer to NULL is returned.
    * @param aDataVector pointer to the returned data vector
@@ -132,6 +161,29 @@ class Omicron {
    */
   bool LoadData(double **aDataVector, int *aSize);
 
+  /**
+   * Loads a data vector in a user buffer.
+   * Same as LoadData() but the data are copied in a vector allocated by the user. The same vector can be used for all chunks and all channels.
+   *
+   * If the vector is too small, this function fails and the required number of samples is returned in `aSize`.
+   * @param aDataVector user data vector
+   * @param aCapacity number of samples allocated in `aDataVector`
+   * @param aSize sample size of the loaded data vector
+   */
+  bool LoadData(double *aDataVector, const int aCapacity, int *aSize);
+
+  /**
+   * Loads a data vector in an internal buffer.
+   * Same as LoadData() but the data vector is not copied: the returned vector belongs to the Omicron object and must not be deleted. It is only valid until the next call to this function or to LoadData(). The buffer is re-used for all chunks and all channels: it is only allocated for the first chunk (or when the chunk size increases). The internal buffers are aligned for vector instructions and can use huge pages, see the @ref omicron_readoptions_data_hugepages "DATA HUGEPAGES" option.
+   *
+   * The data read from the frame files with the @ref omicron_readoptions_data_batchread "batch reading" and the @ref omicron_readoptions_data_rawcache "raw data cache" are also kept in internal buffers. The other reading modes use vectors allocated by the ffl class.
+   *
+   * If this function fails, a pointer to NULL is returned.
+   * @param aDataVector pointer to the returned data vector
+   * @param aSize sample size of the returned data vector
+   */
+  bool LoadDataBuffer(double **aDataVector, int *aSize);
+
   /**
    * Conditions a data vector.
    * Before projecting the data onto the tiles, the data is conditioned and whitened with this function. The input data chunk is first removed its DC component, then resampled, optionally highpassed, Tukey-windowed, Fourier-transformed and whitened twice. In this process, the conditioned data vector is used to update the estimate of the noise power density (PSD).
@@ -159,6 +211,18 @@ class Omicron {
    * The data are projected onto the tiling structure. The number of tiles above threshold is returned. -1 is returned if this function fails.
    */
   int Project(void);
+
+  /**
+   * Runs a sine-Gaussian injection campaign on the current chunk.
+   * Sine-Gaussian waveforms are injected one after the other in the conditioned chunk (noise only): the data are conditioned once for all the injections. The injection parameters are randomly generated, see Oinject. For each injection:
+   * - the Fourier transform of the waveform is computed analytically over its frequency support (+/- SGCAMPAIGN_NSIGMA sigma_f),
+   * - the waveform is whitened with the inverse ASDs of the chunk and added to the whitened noise,
+   * - the data are projected in a time window around the injection (+/- SGCAMPAIGN_NSIGMA sigma_t), see Otile::SetProjectionWindow(); the pruned fft plans are kept for each pruned size, so that they are not re-planned for every injection,
+   * - the injection parameters, the true SNR (computed analytically, see Oinject::GetTrueSNR()) and the recovered SNR (loudest tile in the window) are written in a text file in the channel output directory.
+   *
+   * The whitened noise is restored at the end: this function must be called after Condition() and before Project(). The number of injections is returned. -1 is returned if this function fails.
+   */
+  int InjectCampaign(void);
   
   /**
    * Extract triggers above threshold.
@@ -215,11 +279,13 @@ class Omicron {
   
   /**
    * Returns the number of channels.
+   * Only the channels of the group processed by this object are counted, see Omicron().
    */
   inline int GetNChannels(void){ return nchannels; };
 
   /**
    * Returns list of channels.
+   * Only the channels of the group processed by this object are listed, see Omicron().
    */
   vector <string> GetChannels(void);
 
@@ -295,10 +361,13 @@ class Omicron {
   time_t timer;                 ///< timer
   time_t timer_start;           ///< timer start
   struct tm * ptm;              ///< gmt time
-  int chanindex;                ///< current channel index
+  int chanindex;                ///< current channel index (in the group)
+  int changlobal;               ///< current channel index in the full channel list (all groups)
+  int changroup;                ///< channel group index
+  int nchangroups;              ///< number of channel groups
 
   // OPTIONS
-  void ReadOptions(const int aGpsRef=-1, const bool aStrict=false);
+  void ReadOptions(const int aGpsRef=-1, const bool aStrict=false, const int aChannelGroup=-1);
   string fOptionFile;           ///< option file name
   int fVerbosity;               ///< verbosity level
   string fMaindir;              ///< main output directory
@@ -309,12 +378,22 @@ class Omicron {
   vector <int> fWindows;        ///< plot time windows. FIXME: to move in Otile
   string fClusterAlgo;          ///< clustering algorithm
   string fftplan;               ///< fft plan
+  string fftwisdom;             ///< fftw wisdom file ("none" = no wisdom)
   double fratemax;              ///< maximum trigger rate /chunk
-  vector <string> fInjChan;     ///< injection channel names
-  vector <double> fInjFact;     ///< injection factors
+  vector <string> fChannels;    ///< channel names (all groups)
+  vector <string> fChannelsConv;///< channel names, file naming convention (all groups)
+  vector <string> fInjChan;     ///< injection channel names (all groups)
+  vector <double> fInjFact;     ///< injection factors (all groups)
   int fsginj;                   ///< perform SG injections
+  int fSgCampaign;              ///< number of SG injections per chunk (campaign mode)
+  int fChannelThreads;          ///< number of threads to process the channels
+  int fPrefetch;                ///< data prefetch depth
+  bool fBatchRead;              ///< read all channels in one pass
+  bool fRawCache;               ///< cache the raw data of the last chunk
+  bool fHugePages;              ///< use huge pages for the data buffers
+  bool fPolyphase;              ///< use the polyphase decimator
    
-  // PROCESS MONITORING
+  // PROCESS MONITORING (all groups)
   Segments *inSegments;         ///< requested segments
   Segments **outSegments;       ///< segments currently processed
   int chunk_ctr;                ///< number of called chunks
@@ -330,13 +409,23 @@ class Omicron {
   ofstream oinjfile;            ///< file with sg injection parameters
   
   // COMPONENTS
-  int nchannels;                ///< number of channels
-  vector <string> outdir;       ///< output directories / channel
+  int nchannels;                ///< number of channels (in the group)
+  vector <string> outdir;       ///< output directories / channel (all groups)
   Spectrum **spectrum1;         ///< 1st spectrum structure / channel
   Spectrum **spectrum2;         ///< 2nd spectrum structure / channel
   Spectrum *spectrumw;          ///< spectrum structure to test whitening
   ffl *FFL;                     ///< ffl
   ffl *FFL_inject;              ///< ffl for injection signals
+  Oprefetch *prefetch;          //!< data prefetch
+  vector <Odecimator*> decimators; //!< polyphase decimators (one per native frequency)
+  Odecimator* GetDecimator(const int aNativeFrequency); ///< get the polyphase decimator for a native frequency
+  void Prefetch(void);          ///< request the next data vectors
+  double* ReadData(int &aSize, bool &aOwner, ffl *aFfl, const string aChannel, const int aStart, const int aEnd); ///< read data (prefetched if possible), to delete if aOwner
+  bool ReadBatch(const int aStart, const int aEnd); ///< read all channels in one pass over the frame files
+  double **BatchVect;           ///< data read in one pass / channel, in the arena
+  int *BatchSize;               ///< size of BatchVect / channel
+  int BatchStart;               ///< GPS start of BatchVect
+  int BatchEnd;                 ///< GPS end of BatchVect
   fft *offt;                    ///< FFT plan to FFT the input data
   Otile *tile;                  ///< tiling structure
   TriggerBuffer **triggers;     ///< output triggers / channel
@@ -345,9 +434,28 @@ class Omicron {
 
   // DATA VECTORS
   double *ChunkVect;            ///< chunk raw data (time domain)
+  double *WorkVect;             ///< work buffer (time domain)
+  Oarena *arena;                //!< aligned data buffers: DataVect, BatchVect / channel, RawVect / channel
+  double *DataVect;             ///< data vector returned by LoadDataBuffer(), in the arena
+  double* GetDataBuffer(const int aSize); ///< get DataVect, with at least aSize samples
+  void SetDataBuffer(const int aSize, double *aDataVector, const bool aOwner); ///< fill DataVect with a data vector (deleted if aOwner)
+  double *WhiteVect_r;          ///< chunk whitened data (frequency domain, real part)
+  double *WhiteVect_i;          ///< chunk whitened data (frequency domain, imaginary part)
+  double **RawVect;             ///< raw data of the last chunk (ring indexed by GPS sample) / channel, in the arena
+  int *RawSize;                 ///< size of RawVect / channel
+  int *RawStart;                ///< GPS start of RawVect / channel
+  int *RawEnd;                  ///< GPS end of RawVect / channel
+  int GetCachedData(void);      ///< get chunk data in DataVect, re-using the last chunk
+  void RawCopy(const long int aSample, const int aSize, double *aData, const bool aToCache); ///< copy data to/from RawVect
     
   // CONDITIONING & WHITENING
-  void Whiten(Spectrum *aSpec); ///< whiten data vector
+  void Whiten(const double *aInvASD, const bool aFromCopy); ///< whiten data vector
+  double* GetInverseASD(const int aSpecIndex); ///< get the inverse ASD of the current channel
+  double **InvASD;              ///< inverse ASD on the chunk frequency grid / (channel, spectrum)
+  long int *InvASDVersion;      ///< spectrum version used to compute InvASD / (channel, spectrum)
+  long int *SpecVersion;        ///< spectrum version (incremented when the PSD changes) / (channel, spectrum)
+  double *PsdVect;              //!< PSD sampled on its own frequency bins
+  int PsdSize;                  //!< size of PsdVect
   double* GetTukeyWindow(const int aSize, const int aFractionSize); ///< create tukey window
   double *TukeyWindow;          ///< tukey window
  
@@ -365,6 +473,8 @@ class Omicron {
   static const string colorcode[17];
   string GetColorCode(const double aSNRratio);
   bool IsFlat(const int aInVectSize, double *aInVect);
+  bool ImportFftWisdom(void);   ///< import fftw wisdom from file
+  bool ExportFftWisdom(void);   ///< export fftw wisdom to file
 
   ClassDef(Omicron,0)  
 };
@@ -4,6 +4,7 @@
  * @author Florent Robinet - <a href="mailto:florent.robinet@ijclab.in2p3.fr">florent.robinet@ijclab.in2p3.fr</a>
  */
 #include "Oomicron.h"
+#include <thread>
 
 /**
  * @brief Parse Omicron parameters.
@@ -103,12 +104,47 @@ DATA  LCF  [PARAMETERS]
  *
  * By default, no FFL file is used.
  *
+ * @subsection omicron_readoptions_data_prefetch Data prefetch
+ * @verbatim
+DATA  PREFETCH  [PARAMETER]
+@endverbatim
+ * This option activates the data prefetch: the data of the next channels and chunks are read from the frame files in the background, while the current data are processed. `[PARAMETER]` is the prefetch depth: the maximum number of data vectors read in advance (the main channel and the injection channel count as 2 data vectors). The memory footprint increases with the depth. This option is only used with a @ref omicron_readoptions_data_ffl "frame file list".
+ * By default = 0 (no prefetch).
+ *
+ * @subsection omicron_readoptions_data_rawcache Raw data cache
+ * @verbatim
+DATA  RAWCACHE  [PARAMETER]
+@endverbatim
+ * If `[PARAMETER]` is set to 1, the raw data of the last chunk are kept in memory for each channel. When the next chunk overlaps the last one, only the new data are read from the frame files. The cache is reset at the start of a new segment. The memory footprint is one chunk of raw data per channel. This cache is always used in @ref omicron_readoptions_parameter_stride "streaming mode".
+ * By default = 0.
+ *
+ * @subsection omicron_readoptions_data_batchread Batch reading
+ * @verbatim
+DATA  BATCHREAD  [PARAMETER]
+@endverbatim
+ * If `[PARAMETER]` is set to 1, the data of all the channels are read in one pass over the frame files: when the first channel of a chunk is loaded, every frame file is opened once and the data of all the channels are extracted. This significantly reduces the reading time when many channels are processed. The data of all the channels are kept in memory for the duration of a chunk. With the @ref omicron_readoptions_data_prefetch "data prefetch", only the injection channels are prefetched. The channels which cannot be read in one pass are read individually. This option is only used with a @ref omicron_readoptions_data_ffl "frame file list".
+ * By default = 0.
+ *
+ * @subsection omicron_readoptions_data_hugepages Huge pages
+ * @verbatim
+DATA  HUGEPAGES  [PARAMETER]
+@endverbatim
+ * If `[PARAMETER]` is set to 1, the data buffers larger than 2 MB (data vectors, @ref omicron_readoptions_data_batchread "batch reading" and @ref omicron_readoptions_data_rawcache "raw data cache") are aligned on huge pages and the kernel is advised to use transparent huge pages (Linux only). This reduces the TLB misses for long chunks of high-rate channels. In all cases, the data buffers are allocated once and re-used for all chunks and all channels.
+ * By default = 0.
+ *
  * @subsection omicron_readoptions_data_samplefrequency Working sampling frequency
  * @verbatim
 DATA  SAMPLEFREQUENCY  [PARAMETER]
 @endverbatim
  * This option specifies the working sampling frequency of omicron in [Hz]. All channel time series are sampled to a common frequency before being processed. Only downsampling is supported. The working sampling frequency must be a power of 2 and must be at least 16 Hz.
  *
+ * @subsection omicron_readoptions_data_polyphase Polyphase decimation
+ * @verbatim
+DATA  POLYPHASE  [PARAMETER]
+@endverbatim
+ * If `[PARAMETER]` is set to 1, the channels sampled above the @ref omicron_readoptions_data_samplefrequency "working sampling frequency" are downsampled with a polyphase decimator: a linear-phase FIR low-pass filter (passband up to 90% of the working Nyquist frequency, 80 dB attenuation above the working Nyquist frequency) is applied and only the output samples are computed with vectorized scalar products. The filter is designed once per native sampling frequency. This is significantly faster than the default IIR filters for high-rate channels. The native sampling frequency must be a multiple of the working sampling frequency. This option is ignored when a @ref omicron_readoptions_parameter_highpass "high-pass filter" is used.
+ * By default = 0.
+ *
  * @subsection omicron_readoptions_data_channels List of channels
  * @verbatim
 DATA  CHANNELS  [PARAMETERS]
@@ -221,13 +257,84 @@ PARAMETER  MAPVRANGE  [PARAMETERS]
 @endverbatim
  * This option specifies the vertical range for spectrogram plots.
  *
+ * @subsection omicron_readoptions_parameter_stride Streaming
+ * @verbatim
+PARAMETER  STRIDE  [PARAMETER]
+@endverbatim
+ * This option activates the streaming mode: the chunks are moved forward by `[PARAMETER]` seconds. It must be an even number smaller than the @ref omicron_readoptions_parameter_timing "chunk duration". The overlap duration is set to the chunk duration minus the stride: the overlap given with the `TIMING` option is ignored. In this mode:
+ * - The raw data of the previous chunk are kept in memory: only the last `[PARAMETER]` seconds of a new chunk are read from the frame files.
+ * - Only the tiles between the overlaps (where triggers are saved) are computed, together with the tiles of the largest @ref omicron_readoptions_parameter_windows "map window" if maps are produced.
+ *
+ * The conditioning (whitening) is still performed over the full chunk.
+ * By default, the streaming mode is not active.
+ *
+ * @subsection omicron_readoptions_parameter_powertolerance Noise power tolerance
+ * @verbatim
+PARAMETER  POWERTOLERANCE  [PARAMETER]
+@endverbatim
+ * The noise amplitude of each frequency band (used to compute the tile amplitude) is updated for every chunk. With this option, a band is only updated when the noise power spectral density changed over the band by more than a relative tolerance given by `[PARAMETER]`. The relative error on the tile amplitudes is bounded by this tolerance. This saves time when the noise is stationary, especially for low-frequency configurations.
+ * By default = 0 (the bands are updated as soon as the power changes).
+ *
  * @subsection omicron_readoptions_parameter_fftplan FFT plan
  * @verbatim
 PARAMETER  FFTPLAN  [PARAMETER]
 @endverbatim
- * This option specifies the plan to perform Fourier transforms with FFTW.
+ * This option specifies the plan to perform Fourier transforms with FFTW: "FFTW_ESTIMATE", "FFTW_MEASURE", "FFTW_PATIENT" or "FFTW_EXHAUSTIVE". This plan is used for the data chunk and for the frequency bands of the Q-planes. The frequency bands of a Q-plane with the same number of tiles are transformed together with batched plans.
  * By default = "FFTW_MEASURE".
  *
+ * @subsection omicron_readoptions_parameter_fftwisdom FFTW wisdom
+ * @verbatim
+PARAMETER  FFTWISDOM  [PARAMETER]
+@endverbatim
+ * This option specifies a file path to cache the FFTW plans (wisdom) between jobs. The wisdom is loaded from this file before the FFT plans are created and the file is updated with the new plans. With `FFTW_MEASURE` or slower plans, this saves most of the start-up time of the next jobs. The double-precision wisdom is saved in `[PARAMETER]` and the single-precision wisdom in `[PARAMETER].f`. The file `[PARAMETER].lock` is used to lock the wisdom files so many jobs can share the same files. The wisdom is only valid for the machine where it was computed: use a different file for each type of machine.
+ * By default = "none" (no wisdom file).
+ *
+ * @subsection omicron_readoptions_parameter_precision Projection precision
+ * @verbatim
+PARAMETER  PRECISION [PARAMETER]
+@endverbatim
+ * This option specifies the floating-point precision used to project the data onto the Q-planes:
+ * - `double`: double precision.
+ * - `single`: single precision. The memory footprint of the Q-planes is divided by 2 and the projection is faster. The SNR values are slightly different from the double-precision values.
+ * - `validate`: the data are projected in both precisions. The triggers are computed in double precision. For each analysis window, the maximum SNR deviation between the two precisions is printed.
+ *
+ * By default = "double".
+ *
+ * @subsection omicron_readoptions_parameter_sparseprojection Sparse projection
+ * @verbatim
+PARAMETER  SPARSEPROJECTION [PARAMETER]
+@endverbatim
+ * If `[PARAMETER]` is 1, the frequency bands with a short window (compared to the number of tiles) are projected with an input-pruned fft which only processes the non-zero samples of the window. This is faster for the low-Q planes. The SNR values are not bit-identical to the full fft: the relative deviation is below 1e-9 in double precision.
+ * By default = 0 (full fft).
+ *
+ * @subsection omicron_readoptions_parameter_tilingcache Tiling cache
+ * @verbatim
+PARAMETER  TILINGCACHE [PARAMETER]
+@endverbatim
+ * This option specifies a directory where the tiling is cached. The cache file is identified by the tiling parameters (time range, Q range, frequency range, sampling frequency and mismatch). If a matching cache file exists, the Q-plane windows are mapped from this file instead of being computed, which speeds up the start of the jobs using the same tiling. Otherwise, the cache file is created. Combined with the @ref omicron_readoptions_parameter_fftwisdom "FFTW wisdom", the start-up time of repeated jobs is significantly reduced.
+ * By default = "none" (no cache).
+ *
+ * @subsection omicron_readoptions_parameter_nthreads Number of threads
+ * @verbatim
+PARAMETER  NTHREADS [PARAMETER]
+@endverbatim
+ * This option specifies the number of threads used to project the data onto the Q-planes. The frequency bands of all Q-planes are distributed across the threads. The resulting triggers do not depend on the number of threads. If `[PARAMETER]` is 0, the number of threads is given by the number of available cores.
+ * By default = 1.
+ *
+ * @subsection omicron_readoptions_parameter_channelthreads Number of channel threads
+ * @verbatim
+PARAMETER  CHANNELTHREADS [PARAMETER]
+@endverbatim
+ * This option specifies the number of threads used by the `omicron` program to process the channels in parallel. The channels are dealt to `[PARAMETER]` groups (round-robin). Each group is processed by a separate thread, with its own FFT plans, data buffers and Q-planes. The trigger buffers and the spectra are only built for the channels of the group. The data of the different groups are read and written one group at a time. This option is combined with the @ref omicron_readoptions_parameter_nthreads "number of threads" used to project each channel: the total number of threads is the product of the two numbers. If `[PARAMETER]` is 0, the number of threads is given by the number of available cores. The number of threads is limited to the number of channels.
+ * By default = 1.
+ *
+ * @subsection omicron_readoptions_parameter_coarsemismatch Coarse search
+ * @verbatim
+PARAMETER  COARSEMISMATCH [PARAMETER]
+@endverbatim
+ * This option activates a coarse-to-fine search. The data are first projected onto a coarse tiling built with a mismatch `[PARAMETER]`, which must be larger than the @ref omicron_readoptions_parameter_mismatchmax "maximum mismatch". Then, only the frequency bands close to a coarse tile with a SNR above a reduced threshold are projected at full resolution. The reduced threshold accounts for the energy lost with the coarse mismatch (the energy of a tile is SNR^2+2) and for the noise fluctuations of the coarse tile energy (one standard deviation). The triggers are the same as with the full search, except for some tiles close to the SNR threshold. The other frequency bands are not computed and the spectrograms only show the selected bands. With a verbosity level above 1, the fraction of skipped tiles is printed for each chunk.
+ * By default = 0 (no coarse search).
+ *
  * @subsection omicron_readoptions_parameter_triggerratemax Maximum trigger rate
  * @verbatim
 PARAMETER  TRIGGERRATEMAX [PARAMETER]
@@ -283,6 +390,13 @@ INJECTION  SG [PARAMETER]
 @endverbatim
  * Sine-gauss injections can be performed by setting `[PARAMETER]` to a value different from 0. One waveform is injected in every @ref omicron_readoptions_parameter_timing "analysis window".
  *
+ * @subsection omicron_readoptions_injection_sgcampaign Sine-Gauss injection campaign
+ * @verbatim
+INJECTION  SGCAMPAIGN [PARAMETER]
+@endverbatim
+ * With this option, `[PARAMETER]` sine-Gaussian waveforms are injected, one after the other, in every @ref omicron_readoptions_parameter_timing "analysis window". The data are conditioned once: the waveforms are added to the whitened noise in the frequency domain (the Fourier transform of the waveform is computed analytically) and the data are only projected around the injection time. For each injection, the waveform parameters, the true SNR and the recovered SNR (loudest tile around the injection) are saved in a text file in the channel output directory. The output triggers and products are not affected by the injections. The injection parameters are set with the options below. This option cannot be combined with the @ref omicron_readoptions_injection_sg "SG" option.
+ * By default = 0 (no campaign).
+ *
  * @subsection omicron_readoptions_injection_sgtime Sine-Gauss injection time
  * @verbatim
 INJECTION  SGTIME [PARAMETERS]
@@ -308,7 +422,7 @@ INJECTION  SGAMPLITUDE [PARAMETERS]
 * With this option, the amplitude of the injection is taken as a random value in a given range, following a logarithmic distribution. If only one value is provided, the injection amplitude is fixed at that value.
  *
  */
-void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
+void Omicron::ReadOptions(const int aGpsRef, const bool aStrict, const int aChannelGroup){
 
   // check that the option file exists
   if(!IsTextFile(fOptionFile)){
@@ -385,6 +499,7 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   vector <string> fflfile;
   if(io->GetOpt("DATA","FFL", fflfileopt)||io->GetOpt("DATA","LCF", fflfileopt)){
     fflfile = SplitString(fflfileopt, ' ');
+    lock_guard<recursive_mutex> plock(OfftwPlannerMutex());// ROOT objects
     FFL = new ffl(fflfile[0], outstyle, fVerbosity);
     FFL->SetName("mainffl");
     status_OK*=FFL->DefineTmpDir(fMaindir);
@@ -395,6 +510,16 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   }
   else
     FFL=NULL;
+  if(!io->GetOpt("DATA","PREFETCH", fPrefetch)) fPrefetch=0;
+  int rawcache;
+  if(!io->GetOpt("DATA","RAWCACHE", rawcache)) rawcache=0;
+  fRawCache=(rawcache>0);
+  int batchread;
+  if(!io->GetOpt("DATA","BATCHREAD", batchread)) batchread=0;
+  fBatchRead=(batchread>0)&&(FFL!=NULL);
+  int hugepages;
+  if(!io->GetOpt("DATA","HUGEPAGES", hugepages)) hugepages=0;
+  fHugePages=(hugepages>0);
   //*****************************
 
   
@@ -406,6 +531,9 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   }
   
   //***** Sampling frequency *****
+  int polyphase;
+  if(!io->GetOpt("DATA","POLYPHASE", polyphase)) polyphase=0;
+  fPolyphase=(polyphase>0);
   int sampling;
   if(!io->GetOpt("DATA","SAMPLEFREQUENCY", sampling)){
     cerr<<"Omicron::ReadOptions: a working sampling frequency is required (DATA/SAMPLEFREQUENCY)"<<endl;
@@ -486,13 +614,41 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
     status_OK=false;
   }
   
+  // all channels (monitoring)
+  fChannels=channels;
+  fChannelsConv.clear();
+  for(int c=0; c<(int)fChannels.size(); c++){
+    Streams stream(fChannels[c], 0);
+    fChannelsConv.push_back(stream.GetNameConv());
+  }
+
+  //***** channel groups *****
+  // read before building the channel structures: only the channels of the group are built
+  if(!io->GetOpt("PARAMETER","CHANNELTHREADS", fChannelThreads)) fChannelThreads=1;
+  if(fChannelThreads<=0) fChannelThreads=(int)thread::hardware_concurrency();
+  if(fChannelThreads<=0) fChannelThreads=1;
+  if(fChannelThreads>(int)fChannels.size()) fChannelThreads=(int)fChannels.size();
+  if(aChannelGroup>=fChannelThreads){
+    cerr<<"Omicron::ReadOptions: the channel group "<<aChannelGroup<<" does not exist (PARAMETER/CHANNELTHREADS)"<<endl;
+    status_OK=false;
+  }
+  else if(aChannelGroup>=0){
+    changroup=aChannelGroup;
+    nchangroups=fChannelThreads;
+    channels.clear();
+    for(int c=changroup; c<(int)fChannels.size(); c+=nchangroups) channels.push_back(fChannels[c]);
+  }
+  //*****************************
+
   nchannels = (int)channels.size();
   triggers = new TriggerBuffer* [nchannels];
+  unique_lock<recursive_mutex> plock(OfftwPlannerMutex());// ROOT objects
   for(int c=0; c<nchannels; c++){
     triggers[c] = new TriggerBuffer(bufsize,channels[c],fVerbosity);
     triggers[c]->SetDCRemoval(true);
     status_OK*=triggers[c]->SetFrequencies(sampling,sampling,0.0);
   }
+  plock.unlock();
   channels.clear();
   //*****************************
 
@@ -559,17 +715,69 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   }
   //*****************************
 
+  //***** fft plans *****
+  if(!io->GetOpt("PARAMETER","FFTPLAN", fftplan)){
+    cerr<<"Omicron::ReadOptions: No fftplan option (PARAMETER/FFTPLAN)  --> set default: FFTW_MEASURE"<<endl;
+    fftplan="FFTW_MEASURE";
+  }
+  //*****************************
+
+  //***** fftw wisdom *****
+  if(!io->GetOpt("PARAMETER","FFTWISDOM", fftwisdom)) fftwisdom="none";
+  if(fftwisdom.compare("none")){
+    plock.lock();
+    ImportFftWisdom();
+    plock.unlock();
+  }
+  //*****************************
+
+  //***** projection precision *****
+  string precision;
+  if(!io->GetOpt("PARAMETER","PRECISION", precision)) precision="double";
+  if(precision.compare("double")&&precision.compare("single")&&precision.compare("validate")){
+    cerr<<"Omicron::ReadOptions: the precision (PARAMETER/PRECISION) is not correct  --> set default: double"<<endl;
+    if(aStrict) status_OK=false;
+    precision="double";
+  }
+  //*****************************
+
+  //***** sparse projection *****
+  int sparse;
+  if(!io->GetOpt("PARAMETER","SPARSEPROJECTION", sparse)) sparse=0;
+  //*****************************
+
   //***** maximum mismatch *****
   double mmm;
   if(!io->GetOpt("PARAMETER","MISMATCHMAX", mmm)){
     cerr<<"Omicron::ReadOptions: No mismatch (PARAMETER/MISMATCHMAX)  --> set default: 0.25"<<endl;
     mmm=0.25;
   }
-  tile = new Otile(timing[0],QRange[0],QRange[1],FRange[0],FRange[1],triggers[0]->GetWorkingFrequency(),mmm,outstyle,fVerbosity);// tiling definition
+  //*****************************
+
+  //***** tiling cache *****
+  string tilingcache;
+  if(!io->GetOpt("PARAMETER","TILINGCACHE", tilingcache)) tilingcache="none";
+  plock.lock();// FFTW plans and ROOT objects
+  tile = new Otile(timing[0],QRange[0],QRange[1],FRange[0],FRange[1],triggers[0]->GetWorkingFrequency(),mmm,outstyle,fVerbosity,fftplan,precision,tilingcache,sparse>0);// tiling definition
   if(dims.size()==2){
     tile->ResizePlot(dims[0],dims[1]);
   }
+  plock.unlock();
   tile->SetOverlapDuration(timing[1]);
+  //*****************************
+
+  //***** streaming *****
+  int stride;
+  if(io->GetOpt("PARAMETER","STRIDE", stride)){
+    if(!tile->SetStride(stride)){
+      cerr<<"Omicron::ReadOptions: the stride (PARAMETER/STRIDE) is not correct  --> no streaming"<<endl;
+      if(aStrict) status_OK=false;
+    }
+  }
+  double powertol;
+  if(io->GetOpt("PARAMETER","POWERTOLERANCE", powertol)) tile->SetPowerTolerance(powertol);
+  //*****************************
+
   if(fOutProducts.find("mapsnr")!=string::npos) tile->SetMapFill("snr");
   else if(fOutProducts.find("mapamplitude")!=string::npos) tile->SetMapFill("amplitude");
   else if(fOutProducts.find("mapphase")!=string::npos) tile->SetMapFill("phase");
@@ -595,6 +803,7 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   }
   spectrum1 = new Spectrum* [nchannels];
   spectrum2 = new Spectrum* [nchannels];
+  plock.lock();// FFTW plans
   if(tile->GetFrequencyMin()>1.0){ // resolution = 0.5 Hz above 1 Hz
     for(int c=0; c<nchannels; c++){
       spectrum1[c] = new Spectrum(triggers[0]->GetWorkingFrequency(),psdlength,triggers[0]->GetWorkingFrequency(),fVerbosity);
@@ -609,6 +818,7 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
     }
     spectrumw = new Spectrum(2*NextPowerOfTwo((double)triggers[0]->GetWorkingFrequency()/tile->GetFrequencyMin()),tile->GetTimeRange()-tile->GetOverlapDuration(),triggers[0]->GetWorkingFrequency(),0);
   }
+  plock.unlock();
   //*****************************
 
   //***** set highpass filter *****
@@ -663,13 +873,27 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   tile->SetRangez(mapvrange[0],mapvrange[1]);
   //*****************************
 
-  //***** fft plans *****
-  if(!io->GetOpt("PARAMETER","FFTPLAN", fftplan)){
-    cerr<<"Omicron::ReadOptions: No fftplan option (PARAMETER/FFTPLAN)  --> set default: FFTW_MEASURE"<<endl;
-    fftplan="FFTW_MEASURE";
+  //***** number of threads *****
+  int nthreads;
+  if(!io->GetOpt("PARAMETER","NTHREADS", nthreads)) nthreads=1;
+  tile->SetNThreads(nthreads);
+  //*****************************
+
+  //***** coarse search *****
+  double coarsemismatch;
+  if(!io->GetOpt("PARAMETER","COARSEMISMATCH", coarsemismatch)) coarsemismatch=0.0;
+  if(!tile->SetCoarseSearch(coarsemismatch)){
+    cerr<<"Omicron::ReadOptions: the coarse mismatch (PARAMETER/COARSEMISMATCH) is not correct  --> no coarse search"<<endl;
+    if(aStrict) status_OK=false;
+    tile->SetCoarseSearch(0.0);
   }
   //*****************************
 
+  //***** energy bound *****
+  // skipped bands are missing in maps
+  tile->SetEnergyBound(fOutProducts.find("map")==string::npos);
+  //*****************************
+
   //***** trigger max *****
   if(!io->GetOpt("PARAMETER","TRIGGERRATEMAX", fratemax)){
     cerr<<"Omicron::ReadOptions: No trigger rate limit option (PARAMETER/TRIGGERRATEMAX)  --> set default: 5000 Hz"<<endl;
@@ -696,7 +920,7 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   fflfile.clear();
   FFL_inject=NULL;
   if(io->GetOpt("INJECTION","CHANNELS", fInjChan)){
-    if((int)fInjChan.size()!=nchannels){
+    if(fInjChan.size()!=fChannels.size()){
       cerr<<"Omicron::ReadOptions: INJECTION/CHANNELS is inconsistent with the number of channels"<<endl;
       fInjChan.clear();
     }
@@ -708,10 +932,11 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
       }
     }
     else{
-      for(int i=0; i<nchannels; i++) fInjFact.push_back(1.0);
+      for(int i=0; i<(int)fChannels.size(); i++) fInjFact.push_back(1.0);
     }
     if(io->GetOpt("INJECTION","FFL", fflfileopt)||io->GetOpt("INJECTION","LCF", fflfileopt)){
       fflfile = SplitString(fflfileopt, ' ');
+      lock_guard<recursive_mutex> ilock(OfftwPlannerMutex());// ROOT objects
       FFL_inject = new ffl(fflfile[0], outstyle, fVerbosity);
       FFL_inject->SetName("injffl");
       status_OK*=FFL_inject->DefineTmpDir(fMaindir);
@@ -728,6 +953,7 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   inject=NULL; string injfile;
   if(io->GetOpt("INJECTION","FILENAME", injfile)){
     inject = new InjEct* [nchannels];
+    lock_guard<recursive_mutex> ilock(OfftwPlannerMutex());// ROOT objects
     for(int c=0; c<nchannels; c++) inject[c] = new InjEct(triggers[c],injfile,fVerbosity);
   }
   //*****************************
@@ -735,6 +961,11 @@ void Omicron::ReadOptions(const int aGpsRef, const bool aStrict){
   //***** sg injections *****
   oinj = new Oinject(tile->GetTimeRange());
   if(!io->GetOpt("INJECTION","SG", fsginj)) fsginj=0;
+  if(!io->GetOpt("INJECTION","SGCAMPAIGN", fSgCampaign)) fSgCampaign=0;
+  if(fSgCampaign>0&&fsginj){
+    cerr<<"Omicron::ReadOptions: INJECTION/SG is ignored in the campaign mode (INJECTION/SGCAMPAIGN)"<<endl;
+    fsginj=0;
+  }
 
   vector <double> param;
   if(io->GetOpt("INJECTION","SGTIME", param)){
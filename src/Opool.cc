@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Opool.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+Opool::Opool(const int aNthreads){
+////////////////////////////////////////////////////////////////////////////////////
+
+  nthreads=TMath::Max(1,aNthreads);
+  queue     = new deque<int> [nthreads];
+  queue_mtx = new mutex [nthreads];
+  pool_batch=0;
+  pool_active=0;
+  pool_stop=false;
+  pool_work=NULL;
+
+  // start worker threads (thread #0 is the caller)
+  workers = new thread [nthreads-1];
+  for(int t=1; t<nthreads; t++) workers[t-1] = thread(&Opool::Worker, this, t);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Opool::~Opool(void){
+////////////////////////////////////////////////////////////////////////////////////
+  {
+    unique_lock<mutex> lock(pool_mtx);
+    pool_stop=true;
+  }
+  pool_start.notify_all();
+  for(int t=1; t<nthreads; t++) workers[t-1].join();
+  delete [] workers;
+  delete [] queue;
+  delete [] queue_mtx;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Opool::Run(const int aNitems, const function<void(const int, const int)> &aWork){
+////////////////////////////////////////////////////////////////////////////////////
+  if(aNitems<=0) return;
+
+  // single thread
+  if(nthreads==1){
+    for(int i=0; i<aNitems; i++) aWork(i,0);
+    return;
+  }
+
+  // deal work items (no thread is active at this point)
+  for(int i=0; i<aNitems; i++) queue[i%nthreads].push_back(i);
+
+  // start batch
+  {
+    unique_lock<mutex> lock(pool_mtx);
+    pool_work=&aWork;
+    pool_active=nthreads-1;
+    pool_batch++;
+  }
+  pool_start.notify_all();
+
+  // the caller is thread #0
+  while(RunItem(0)) continue;
+
+  // wait for the other threads to finish
+  unique_lock<mutex> lock(pool_mtx);
+  pool_done.wait(lock, [this]{ return pool_active==0; });
+  pool_work=NULL;
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Opool::Worker(const int aThreadIndex){
+////////////////////////////////////////////////////////////////////////////////////
+  unsigned long batch=0;
+
+  while(true){
+
+    // wait for a new batch
+    {
+      unique_lock<mutex> lock(pool_mtx);
+      pool_start.wait(lock, [this, batch]{ return pool_stop||pool_batch!=batch; });
+      if(pool_stop) return;
+      batch=pool_batch;
+    }
+
+    // process work items
+    while(RunItem(aThreadIndex)) continue;
+
+    // end of batch for this thread
+    {
+      unique_lock<mutex> lock(pool_mtx);
+      pool_active--;
+      if(!pool_active) pool_done.notify_all();
+    }
+  }
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Opool::RunItem(const int aThreadIndex){
+////////////////////////////////////////////////////////////////////////////////////
+  int item=-1;
+
+  // own queue: first item
+  {
+    unique_lock<mutex> lock(queue_mtx[aThreadIndex]);
+    if(!queue[aThreadIndex].empty()){
+      item=queue[aThreadIndex].front();
+      queue[aThreadIndex].pop_front();
+    }
+  }
+
+  // steal: last item of other queues
+  for(int t=1; item<0&&t<nthreads; t++){
+    int victim=(aThreadIndex+t)%nthreads;
+    unique_lock<mutex> lock(queue_mtx[victim]);
+    if(!queue[victim].empty()){
+      item=queue[victim].back();
+      queue[victim].pop_back();
+    }
+  }
+
+  // no more items
+  if(item<0) return false;
+
+  (*pool_work)(item, aThreadIndex);
+  return true;
+}
@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#ifndef __Opool__
+#define __Opool__
+
+#include <CUtils.h>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+/**
+ * Run a list of work items on a pool of threads.
+ * This class was designed to distribute independent work items across a fixed number of threads. The threads are started when the pool is constructed and they are kept alive until the pool is destroyed.
+ *
+ * The work items are identified by an index. When calling Run(), the items are dealt to one queue per thread, in the order given by the index. Each thread processes its own queue first. When this queue is empty, the thread steals items at the back of the other queues. This way, the load is balanced even if the work items have very different costs. For a better balance, the most expensive items should be given first.
+ *
+ * The thread calling Run() also processes work items. Run() only returns when all the work items have been processed.
+ * \author    Florent Robinet
+ */
+class Opool {
+
+ public:
+
+  /**
+   * Constructor of the Opool class.
+   * The requested number of threads includes the calling thread: aNthreads-1 threads are started.
+   * @param aNthreads number of threads
+   */
+  Opool(const int aNthreads);
+
+  /**
+   * Destructor of the Opool class.
+   * The threads are stopped and joined.
+   */
+  virtual ~Opool(void);
+
+  /**
+   * Runs a list of work items.
+   * The work function is called once for every work item index in [0, aNitems[. The function arguments are the work item index and the index of the thread (in [0, GetNThreads()[) running the item.
+   * This function returns when all the items have been processed.
+   * @param aNitems number of work items
+   * @param aWork work function
+   */
+  void Run(const int aNitems, const function<void(const int, const int)> &aWork);
+
+  /**
+   * Returns the number of threads, including the calling thread.
+   */
+  inline int GetNThreads(void){ return nthreads; };
+
+ private:
+
+  int nthreads;                     ///< number of threads
+  thread *workers;                  ///< worker threads (nthreads-1)
+  deque <int> *queue;               ///< work item queue / thread
+  mutex *queue_mtx;                 ///< queue mutex / thread
+
+  mutex pool_mtx;                   ///< pool mutex
+  condition_variable pool_start;    ///< signal a new batch
+  condition_variable pool_done;     ///< signal the end of a batch
+  unsigned long pool_batch;         ///< batch counter
+  int pool_active;                  ///< number of worker threads in the current batch
+  bool pool_stop;                   ///< stop flag
+  const function<void(const int, const int)> *pool_work; ///< current work function
+
+  void Worker(const int aThreadIndex);   ///< worker thread loop
+  bool RunItem(const int aThreadIndex);  ///< run one item (own queue, then steal)
+
+};
+
+#endif
+
+
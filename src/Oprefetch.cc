@@ -0,0 +1,171 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Oprefetch.h"
+
+////////////////////////////////////////////////////////////////////////////////////
+Oprefetch::Oprefetch(const int aDepth, mutex *aReadMutex){
+////////////////////////////////////////////////////////////////////////////////////
+
+  depth=aDepth;
+  if(depth<1) depth=1;
+  read_mtx=aReadMutex;
+  stop=false;
+
+  // start background thread
+  reader = thread(&Oprefetch::Reader, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Oprefetch::~Oprefetch(void){
+////////////////////////////////////////////////////////////////////////////////////
+  {
+    unique_lock<mutex> lock(req_mtx);
+    stop=true;
+  }
+  req_new.notify_all();
+  reader.join();
+
+  // the background thread is over: all requests can be deleted
+  for(int r=0; r<(int)requests.size(); r++){
+    delete [] requests[r]->data;
+    delete requests[r];
+  }
+  requests.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Oprefetch::Request(ffl *aFfl, const string aChannel, const int aStart, const int aEnd){
+////////////////////////////////////////////////////////////////////////////////////
+  unique_lock<mutex> lock(req_mtx);
+
+  // already requested
+  for(int r=0; r<(int)requests.size(); r++){
+    if(requests[r]->stream==aFfl&&requests[r]->start==aStart&&requests[r]->end==aEnd&&!requests[r]->channel.compare(aChannel))
+      return true;
+  }
+
+  // too many requests
+  if((int)requests.size()>=depth) return false;
+
+  OprefetchRequest *req = new OprefetchRequest;
+  req->stream  = aFfl;
+  req->channel = aChannel;
+  req->start   = aStart;
+  req->end     = aEnd;
+  req->data    = NULL;
+  req->size    = 0;
+  req->started = false;
+  req->done    = false;
+  req->orphan  = false;
+  requests.push_back(req);
+  lock.unlock();
+
+  req_new.notify_one();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+double* Oprefetch::GetData(int &aSize, ffl *aFfl, const string aChannel, const int aStart, const int aEnd){
+////////////////////////////////////////////////////////////////////////////////////
+  unique_lock<mutex> lock(req_mtx);
+
+  // find request
+  int r=0;
+  for(; r<(int)requests.size(); r++){
+    if(requests[r]->stream==aFfl&&requests[r]->start==aStart&&requests[r]->end==aEnd&&!requests[r]->channel.compare(aChannel))
+      break;
+  }
+
+  // not requested: the predictions are wrong --> start again
+  if(r==(int)requests.size()){
+    while(requests.size()){
+      Discard(requests.front());
+      requests.pop_front();
+    }
+    lock.unlock();
+    return Read(aSize, aFfl, aChannel, aStart, aEnd);
+  }
+
+  // discard previous requests
+  for(; r>0; r--){
+    Discard(requests.front());
+    requests.pop_front();
+  }
+
+  // wait for the data
+  OprefetchRequest *req = requests.front();
+  req_done.wait(lock, [req]{ return req->done; });
+  requests.pop_front();
+  lock.unlock();
+
+  double *data = req->data;
+  aSize = req->size;
+  delete req;
+  return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Oprefetch::Reader(void){
+////////////////////////////////////////////////////////////////////////////////////
+  OprefetchRequest *req;
+  int r;
+
+  while(true){
+
+    // wait for a request to read
+    unique_lock<mutex> lock(req_mtx);
+    req_new.wait(lock, [this, &r]{
+	if(stop) return true;
+	for(r=0; r<(int)requests.size(); r++) if(!requests[r]->started) return true;
+	return false;
+      });
+    if(stop) return;
+    req = requests[r];
+    req->started=true;
+    lock.unlock();
+
+    // read data
+    int size;
+    double *data = Read(size, req->stream, req->channel, req->start, req->end);
+
+    // done
+    lock.lock();
+    if(req->orphan){
+      delete [] data;
+      delete req;
+      continue;
+    }
+    req->data=data;
+    req->size=size;
+    req->done=true;
+    lock.unlock();
+    req_done.notify_all();
+  }
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+double* Oprefetch::Read(int &aSize, ffl *aFfl, const string aChannel, const int aStart, const int aEnd){
+////////////////////////////////////////////////////////////////////////////////////
+  if(read_mtx!=NULL) read_mtx->lock();
+  double *data = aFfl->GetData(aSize, aChannel, aStart, aEnd);
+  if(read_mtx!=NULL) read_mtx->unlock();
+  return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Oprefetch::Discard(OprefetchRequest *aRequest){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // being read: the background thread deletes it
+  if(aRequest->started&&!aRequest->done){
+    aRequest->orphan=true;
+    return;
+  }
+
+  delete [] aRequest->data;
+  delete aRequest;
+  return;
+}
@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#ifndef __Oprefetch__
+#define __Oprefetch__
+
+#include <ffl.h>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+/**
+ * Data read request.
+ */
+struct OprefetchRequest {
+  ffl *stream;             ///< ffl to read
+  string channel;          ///< channel name
+  int start;               ///< GPS start
+  int end;                 ///< GPS end
+  double *data;            ///< data vector
+  int size;                ///< data vector size
+  bool started;            ///< the reading has started
+  bool done;               ///< the reading is over
+  bool orphan;             ///< the data will never be used
+};
+
+/**
+ * Read frame data in the background.
+ * This class was designed to hide the time spent reading frame files. The data vectors are requested in advance with Request(). They are read, in the order of the requests, by a background thread. The data vectors are then collected with GetData(). If the data vector was not requested, it is read by the calling thread.
+ *
+ * The requests must be collected in the same order as they were made. When a data vector is collected, the previous requests are discarded: they are considered to be wrong predictions.
+ *
+ * The number of pending requests is limited by the prefetch depth. The memory footprint is therefore bounded by the depth times the size of the data vectors.
+ * \author    Florent Robinet
+ */
+class Oprefetch {
+
+ public:
+
+  /**
+   * Constructor of the Oprefetch class.
+   * The background thread is started.
+   * @param aDepth maximum number of pending requests
+   * @param aReadMutex mutex to lock when reading frame files (NULL = no lock)
+   */
+  Oprefetch(const int aDepth, mutex *aReadMutex=NULL);
+
+  /**
+   * Destructor of the Oprefetch class.
+   * The background thread is stopped and the pending data vectors are deleted.
+   */
+  virtual ~Oprefetch(void);
+
+  /**
+   * Requests a data vector.
+   * The data vector will be read in the background. false is returned if the maximum number of pending requests is reached. Requesting twice the same data vector has no effect.
+   * @param aFfl ffl to read
+   * @param aChannel channel name
+   * @param aStart GPS start
+   * @param aEnd GPS end
+   */
+  bool Request(ffl *aFfl, const string aChannel, const int aStart, const int aEnd);
+
+  /**
+   * Returns a data vector.
+   * If the data vector was requested, this function waits until the data are read. Otherwise the data vector is read now. See ffl::GetData(). The requests made before this one are discarded.
+   *
+   * It is the user's responsibility to delete the returned data vector.
+   * @param aSize returned data vector size
+   * @param aFfl ffl to read
+   * @param aChannel channel name
+   * @param aStart GPS start
+   * @param aEnd GPS end
+   */
+  double* GetData(int &aSize, ffl *aFfl, const string aChannel, const int aStart, const int aEnd);
+
+  /**
+   * Returns the prefetch depth.
+   */
+  inline int GetDepth(void){ return depth; };
+
+ private:
+
+  int depth;                           ///< maximum number of pending requests
+  mutex *read_mtx;                     ///< frame reading mutex
+  deque <OprefetchRequest*> requests;  ///< pending requests
+  mutex req_mtx;                       ///< request mutex
+  condition_variable req_new;          ///< signal a new request
+  condition_variable req_done;         ///< signal a finished request
+  bool stop;                           ///< stop flag
+  thread reader;                       ///< background thread
+
+  void Reader(void);                   ///< background thread loop
+  double* Read(int &aSize, ffl *aFfl, const string aChannel, const int aStart, const int aEnd); ///< read data
+  void Discard(OprefetchRequest *aRequest); ///< discard a request
+
+};
+
+#endif
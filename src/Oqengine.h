@@ -0,0 +1,635 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#ifndef __Oqengine__
+#define __Oqengine__
+
+#include <TMath.h>
+#include <fftw3.h>
+#include <mutex>
+#include "Osimd.h"
+
+using namespace std;
+
+/**
+ * Returns the mutex protecting the FFTW planner.
+ * The FFTW planner is not thread-safe: plans must be created and destroyed one at a time, in the whole process. This mutex is locked by all the Offtw planning functions. It is recursive so it can be held while building objects creating plans (see Omicron::Omicron()).
+ */
+inline recursive_mutex& OfftwPlannerMutex(void){ static recursive_mutex mtx; return mtx; }
+
+/**
+ * FFTW interface for a given floating-point type.
+ * This structure is specialized for double precision (fftw_) and single precision (fftwf_).
+ */
+template <typename T> struct Offtw {};
+
+/**
+ * FFTW interface: double precision.
+ */
+template <> struct Offtw<double> {
+  typedef fftw_complex Complex; ///< complex type
+  typedef fftw_plan Plan;       ///< plan type
+  static inline Complex* Malloc(const size_t aN){ return (Complex*)fftw_malloc(aN*sizeof(Complex)); };
+  static inline void Free(Complex *aData){ fftw_free(aData); };
+  static inline Plan PlanBackward(int aN, const int aHowMany, Complex *aIn, Complex *aOut, const unsigned int aFlag){
+    lock_guard<recursive_mutex> lock(OfftwPlannerMutex());
+    return fftw_plan_many_dft(1, &aN, aHowMany, aIn, NULL, 1, aN, aOut, NULL, 1, aN, FFTW_BACKWARD, aFlag);
+  };
+  static inline Plan PlanPruned(const int aN, const int aStride, const int aHowMany, const int aDist, Complex *aIn, Complex *aOut, const unsigned int aFlag){
+    lock_guard<recursive_mutex> lock(OfftwPlannerMutex());
+    fftw_iodim dim = {aN, aStride, 1};
+    fftw_iodim howmany[2] = {{aHowMany, aDist, aDist}, {aStride, 1, aN}};
+    return fftw_plan_guru_dft(1, &dim, 2, howmany, aIn, aOut, FFTW_BACKWARD, aFlag);
+  };
+  static inline Plan PlanSparse(const int aN, const int aNseq, const int aHowMany, const int aDist, Complex *aIn, Complex *aOut, const unsigned int aFlag){
+    lock_guard<recursive_mutex> lock(OfftwPlannerMutex());
+    fftw_iodim dim = {aN, 1, aNseq};
+    fftw_iodim howmany[2] = {{aHowMany, aDist, aDist}, {aNseq, aN, 1}};
+    return fftw_plan_guru_dft(1, &dim, 2, howmany, aIn, aOut, FFTW_BACKWARD, aFlag);
+  };
+  static inline void Execute(const Plan aPlan){ fftw_execute(aPlan); };
+  static inline void Destroy(Plan aPlan){ lock_guard<recursive_mutex> lock(OfftwPlannerMutex()); fftw_destroy_plan(aPlan); };
+};
+
+/**
+ * FFTW interface: single precision.
+ */
+template <> struct Offtw<float> {
+  typedef fftwf_complex Complex; ///< complex type
+  typedef fftwf_plan Plan;       ///< plan type
+  static inline Complex* Malloc(const size_t aN){ return (Complex*)fftwf_malloc(aN*sizeof(Complex)); };
+  static inline void Free(Complex *aData){ fftwf_free(aData); };
+  static inline Plan PlanBackward(int aN, const int aHowMany, Complex *aIn, Complex *aOut, const unsigned int aFlag){
+    lock_guard<recursive_mutex> lock(OfftwPlannerMutex());
+    return fftwf_plan_many_dft(1, &aN, aHowMany, aIn, NULL, 1, aN, aOut, NULL, 1, aN, FFTW_BACKWARD, aFlag);
+  };
+  static inline Plan PlanPruned(const int aN, const int aStride, const int aHowMany, const int aDist, Complex *aIn, Complex *aOut, const unsigned int aFlag){
+    lock_guard<recursive_mutex> lock(OfftwPlannerMutex());
+    fftw_iodim dim = {aN, aStride, 1};
+    fftw_iodim howmany[2] = {{aHowMany, aDist, aDist}, {aStride, 1, aN}};
+    return fftwf_plan_guru_dft(1, &dim, 2, howmany, aIn, aOut, FFTW_BACKWARD, aFlag);
+  };
+  static inline Plan PlanSparse(const int aN, const int aNseq, const int aHowMany, const int aDist, Complex *aIn, Complex *aOut, const unsigned int aFlag){
+    lock_guard<recursive_mutex> lock(OfftwPlannerMutex());
+    fftw_iodim dim = {aN, 1, aNseq};
+    fftw_iodim howmany[2] = {{aHowMany, aDist, aDist}, {aNseq, aN, 1}};
+    return fftwf_plan_guru_dft(1, &dim, 2, howmany, aIn, aOut, FFTW_BACKWARD, aFlag);
+  };
+  static inline void Execute(const Plan aPlan){ fftwf_execute(aPlan); };
+  static inline void Destroy(Plan aPlan){ lock_guard<recursive_mutex> lock(OfftwPlannerMutex()); fftwf_destroy_plan(aPlan); };
+};
+
+/**
+ * Projection engine of a Q-plane.
+ * This class holds the windows, the data vectors and the fft plans used to project data onto the frequency bands of a Q-plane. It is templated on the floating-point type (double or float). The frequency bands are grouped in batches: the bands of a batch have the same number of tiles and they are transformed together.
+ *
+ * When only a range of time tiles is needed (see SetOutputRange()), the backward fft of a batch can be pruned: with N=P*M tiles, the band vector is split in M interleaved sequences which are transformed with M ffts of size P. The requested time tiles are then obtained by combining the M results:
+ * \verbatim
+ x[t] = sum_a exp(2*i*pi*a*t/N) * Y_a[t%P]
+ \endverbatim
+ * The size P is chosen to minimize a cost model. If no pruned transform is cheaper, the full fft is used. P is a power of 2: the plans are created on demand and kept for each size, so that changing the output range (e.g. for every injection of a campaign) never re-plans a size already used.
+ *
+ * Only the W samples of the bisquare window are non-zero in a band vector. When W is small compared to N, the backward fft of a batch can exploit this sparsity: with L=NextPowerOfTwo(W) and N=L*K, the time tiles are computed as K interleaved sequences, each obtained with a fft of size L:
+ * \verbatim
+ x[p+K*q] = exp(-2*i*pi*n*(p+K*q)/N) * sum_m (w[m]*v[m]*exp(2*i*pi*m*p/N)) * exp(2*i*pi*m*q/L)
+ \endverbatim
+ * where the window samples m are counted from the first negative frequency (index -n). The twiddle factors are included in the windows. The phase factor in front is only applied when computing the tile phase (see GetPhase()). This input-pruned transform is only available when it is requested in the constructor. It is then used when it is cheaper than the full fft and than the output-pruned fft. The Q coefficients are the same as with the full fft, up to rounding errors: the sum over the window samples is performed in a different order.
+ *
+ * This class is entirely private and can only be used through the Oqplane class.
+ * \author    Florent Robinet
+ */
+template <typename T> class Oqengine {
+
+ public:
+  friend class Oqplane;  ///< Friendly class
+
+ private:
+
+  /**
+   * Constructor of the Oqengine class.
+   * The data vectors and the fft plans are created. The windows must be given with SetWindows().
+   * @param aNbands number of frequency bands
+   * @param aBandNtiles number of tiles / band
+   * @param aBandShift frequency index of the band center / band
+   * @param aBandWindowSize window size / band
+   * @param aNbatches number of batches
+   * @param aBatchStart first band / batch
+   * @param aBatchSize number of bands / batch
+   * @param aPlanFlag FFTW plan flag
+   * @param aSparse set to true to allow the input-pruned fft
+   */
+  Oqengine(const int aNbands, const int *aBandNtiles, const int *aBandShift, const int *aBandWindowSize,
+           const int aNbatches, const int *aBatchStart, const int *aBatchSize,
+           const unsigned int aPlanFlag, const bool aSparse=false);
+  virtual ~Oqengine(void);
+
+  // set the windows of all bands (converted to T)
+  // aWindows: for each band, the real then the imaginary parts
+  void SetWindows(const double *aWindows);
+
+  // populate the band data vector (\tilde{v})
+  void Window(const int aBandIndex, const T *aDataRe, const T *aDataIm);
+
+  // time tiles to compute for a batch
+  void SetOutputRange(const int aBatchIndex, const int aTimeTileStart, const int aTimeTileEnd);
+
+  // fft-backward of a batch
+  void Execute(const int aBatchIndex);
+
+  // set the Q coefficients of a batch to 0 (batch not projected)
+  void Clear(const int aBatchIndex);
+
+  // pruned fft size minimizing the cost model (0 = full fft)
+  static int GetPrunedSize(const int aNtiles, const int aNout);
+
+  // cost models (flops)
+  static double GetFullCost(const int aNtiles);
+  static double GetPrunedCost(const int aNtiles, const int aNout, const int aPrunedSize);
+  static double GetSparseCost(const int aNtiles, const int aSparseSize, const int aWindowSize);
+
+  // Q coefficients
+  inline double GetNorm2(const int aTimeTileIndex, const int aBandIndex){
+    return (double)bandData_t[aBandIndex][aTimeTileIndex][0]*(double)bandData_t[aBandIndex][aTimeTileIndex][0]
+      +    (double)bandData_t[aBandIndex][aTimeTileIndex][1]*(double)bandData_t[aBandIndex][aTimeTileIndex][1];
+  };
+  inline double GetPhase(const int aTimeTileIndex, const int aBandIndex){
+    double phase=atan2((double)bandData_t[aBandIndex][aTimeTileIndex][1],(double)bandData_t[aBandIndex][aTimeTileIndex][0]);
+    if(batchMode[bandBatch[aBandIndex]]!=2) return phase;
+
+    // input-pruned fft: phase factor exp(-2*i*pi*n*t/N)
+    phase-=2.0*TMath::Pi()*(double)(((long int)((bandWindowSize[aBandIndex]-1)/2)*(long int)aTimeTileIndex)%(long int)bandNtiles[aBandIndex])/(double)bandNtiles[aBandIndex];
+    if(phase<=-TMath::Pi()) phase+=2.0*TMath::Pi();
+    if(phase<=-TMath::Pi()) phase+=2.0*TMath::Pi();
+    return phase;
+  };
+
+  int nbands;                                  ///< number of bands
+  int *bandNtiles;                             ///< number of tiles / band
+  int *bandShift;                              ///< frequency index of the band center / band
+  int *bandWindowSize;                         ///< window size / band
+  T **bandWindow_r;                            ///< band bisquare windows (real)
+  T **bandWindow_i;                            ///< band bisquare windows (imaginary)
+  T **bandSparseWindow_r;                      ///< band windows with twiddle factors, input-pruned fft (real)
+  T **bandSparseWindow_i;                      ///< band windows with twiddle factors, input-pruned fft (imaginary)
+  int *bandBatch;                              ///< batch index / band
+  typename Offtw<T>::Complex **bandData_f;     ///< band data vectors (frequency domain), in batchData_f
+  typename Offtw<T>::Complex **bandData_t;     ///< band data vectors (time domain), in batchData_t
+
+  int nbatches;                                ///< number of batches
+  typename Offtw<T>::Complex **batchData_f;    ///< batch data vectors (frequency domain)
+  typename Offtw<T>::Complex **batchData_t;    ///< batch data vectors (time domain)
+  typename Offtw<T>::Plan *batchPlan;          ///< batch fft plans (backward)
+  int *batchStart;                             ///< first band / batch
+  int *batchSize;                              ///< number of bands / batch
+  unsigned int planFlag;                       ///< FFTW plan flag
+
+  int *batchOutStart;                          ///< first time tile to compute / batch
+  int *batchOutEnd;                            ///< last time tile to compute (excluded) / batch
+  int *batchMode;                              ///< fft mode / batch: 0=full, 1=output-pruned, 2=input-pruned
+  int *batchPrunedSize;                        ///< output-pruned fft size / batch (0 = none)
+  int *batchSparseSize;                        ///< input-pruned fft size / batch (0 = none)
+  typename Offtw<T>::Plan *batchSparsePlan;    ///< input-pruned fft plans / batch
+  typename Offtw<T>::Plan *batchPrunedPlan;    ///< current pruned fft plan / batch
+  typename Offtw<T>::Plan **batchPrunedPlans;  ///< pruned fft plans / batch / log2(pruned size), created on demand
+  typename Offtw<T>::Complex **batchPrunedData;///< pruned fft outputs / batch
+  typename Offtw<T>::Complex **batchTwiddle;   ///< exp(2*i*pi*k/N) / batch
+};
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+Oqengine<T>::Oqengine(const int aNbands, const int *aBandNtiles, const int *aBandShift, const int *aBandWindowSize,
+                      const int aNbatches, const int *aBatchStart, const int *aBatchSize,
+                      const unsigned int aPlanFlag, const bool aSparse){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // bands
+  nbands         = aNbands;
+  bandNtiles     = new int [nbands];
+  bandShift      = new int [nbands];
+  bandWindowSize = new int [nbands];
+  bandWindow_r   = new T* [nbands];
+  bandWindow_i   = new T* [nbands];
+  bandSparseWindow_r = new T* [nbands];
+  bandSparseWindow_i = new T* [nbands];
+  bandBatch      = new int [nbands];
+  bandData_f     = new typename Offtw<T>::Complex* [nbands];
+  bandData_t     = new typename Offtw<T>::Complex* [nbands];
+  for(int f=0; f<nbands; f++){
+    bandNtiles[f]     = aBandNtiles[f];
+    bandShift[f]      = aBandShift[f];
+    bandWindowSize[f] = aBandWindowSize[f];
+    bandWindow_r[f]   = new T [bandWindowSize[f]];
+    bandWindow_i[f]   = new T [bandWindowSize[f]];
+    bandSparseWindow_r[f] = NULL;
+    bandSparseWindow_i[f] = NULL;
+  }
+
+  // batches
+  int n, k, wmax, lsize;
+  bool contiguous;
+  nbatches    = aNbatches;
+  batchData_f = new typename Offtw<T>::Complex* [nbatches];
+  batchData_t = new typename Offtw<T>::Complex* [nbatches];
+  batchPlan   = new typename Offtw<T>::Plan [nbatches];
+  batchStart  = new int [nbatches];
+  batchSize   = new int [nbatches];
+  planFlag    = aPlanFlag;
+  batchOutStart   = new int [nbatches];
+  batchOutEnd     = new int [nbatches];
+  batchMode       = new int [nbatches];
+  batchPrunedSize = new int [nbatches];
+  batchSparseSize = new int [nbatches];
+  batchSparsePlan = new typename Offtw<T>::Plan [nbatches];
+  batchPrunedPlan = new typename Offtw<T>::Plan [nbatches];
+  batchPrunedPlans= new typename Offtw<T>::Plan* [nbatches];
+  batchPrunedData = new typename Offtw<T>::Complex* [nbatches];
+  batchTwiddle    = new typename Offtw<T>::Complex* [nbatches];
+  for(int b=0; b<nbatches; b++){
+    batchStart[b]=aBatchStart[b];
+    batchSize[b]=aBatchSize[b];
+    n=bandNtiles[aBatchStart[b]];
+
+    // all time tiles: full fft
+    batchOutStart[b]=0;
+    batchOutEnd[b]=n;
+    batchMode[b]=0;
+    batchPrunedSize[b]=0;
+    batchPrunedPlan[b]=NULL;
+    batchPrunedData[b]=NULL;
+    batchTwiddle[b]=NULL;
+    for(lsize=0; (1<<lsize)<n; lsize++) continue;
+    batchPrunedPlans[b] = new typename Offtw<T>::Plan [lsize+1];
+    for(k=0; k<=lsize; k++) batchPrunedPlans[b][k]=NULL;
+
+    batchData_f[b] = Offtw<T>::Malloc(aBatchSize[b]*n);
+    batchData_t[b] = Offtw<T>::Malloc(aBatchSize[b]*n);
+    batchPlan[b]   = Offtw<T>::PlanBackward(n, aBatchSize[b], batchData_f[b], batchData_t[b], aPlanFlag|FFTW_PRESERVE_INPUT);
+
+    // input-pruned fft
+    // the data samples must be contiguous (always true for Q>=sqrt(11))
+    wmax=0; contiguous=true;
+    for(int f=aBatchStart[b]; f<aBatchStart[b]+aBatchSize[b]; f++){
+      wmax=TMath::Max(wmax,bandWindowSize[f]);
+      if(bandShift[f]<(bandWindowSize[f]-1)/2) contiguous=false;
+    }
+    for(lsize=1; lsize<wmax; lsize*=2) continue;
+    batchSparseSize[b]=0;
+    batchSparsePlan[b]=NULL;
+    if(aSparse&&contiguous&&lsize<n&&GetSparseCost(n,lsize,wmax)<GetFullCost(n)){
+      batchSparseSize[b]=lsize;
+      batchSparsePlan[b]=Offtw<T>::PlanSparse(lsize, n/lsize, aBatchSize[b], n, batchData_f[b], batchData_t[b], aPlanFlag|FFTW_PRESERVE_INPUT);
+      batchMode[b]=2;
+    }
+
+    // the input vectors are preserved by the fft: the zeros between the window halves are set once for all
+    // (after planning: the arrays can be overwritten when measuring the plan)
+    for(k=0; k<aBatchSize[b]*n; k++){
+      batchData_f[b][k][0]=0.0; batchData_f[b][k][1]=0.0;
+      batchData_t[b][k][0]=0.0; batchData_t[b][k][1]=0.0;
+    }
+
+    // band vectors
+    for(int f=aBatchStart[b]; f<aBatchStart[b]+aBatchSize[b]; f++){
+      bandData_f[f]=batchData_f[b]+(f-aBatchStart[b])*n;
+      bandData_t[f]=batchData_t[b]+(f-aBatchStart[b])*n;
+      bandBatch[f]=b;
+      if(batchSparseSize[b]){
+        bandSparseWindow_r[f] = new T [n/batchSparseSize[b]*bandWindowSize[f]];
+        bandSparseWindow_i[f] = new T [n/batchSparseSize[b]*bandWindowSize[f]];
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+Oqengine<T>::~Oqengine(void){
+////////////////////////////////////////////////////////////////////////////////////
+  for(int b=0; b<nbatches; b++){
+    Offtw<T>::Destroy(batchPlan[b]);
+    Offtw<T>::Free(batchData_f[b]);
+    Offtw<T>::Free(batchData_t[b]);
+    if(batchPrunedData[b]!=NULL){
+      for(int l=0; (1<<l)<bandNtiles[batchStart[b]]; l++){
+        if(batchPrunedPlans[b][l]!=NULL) Offtw<T>::Destroy(batchPrunedPlans[b][l]);
+      }
+      Offtw<T>::Free(batchPrunedData[b]);
+      Offtw<T>::Free(batchTwiddle[b]);
+    }
+    delete [] batchPrunedPlans[b];
+    if(batchSparseSize[b]) Offtw<T>::Destroy(batchSparsePlan[b]);
+  }
+  delete [] batchStart;
+  delete [] batchSize;
+  delete [] batchOutStart;
+  delete [] batchOutEnd;
+  delete [] batchMode;
+  delete [] batchPrunedSize;
+  delete [] batchSparseSize;
+  delete [] batchSparsePlan;
+  delete [] batchPrunedPlan;
+  delete [] batchPrunedPlans;
+  delete [] batchPrunedData;
+  delete [] batchTwiddle;
+  for(int f=0; f<nbands; f++){
+    delete [] bandWindow_r[f];
+    delete [] bandWindow_i[f];
+    delete [] bandSparseWindow_r[f];
+    delete [] bandSparseWindow_i[f];
+  }
+  delete [] bandSparseWindow_r;
+  delete [] bandSparseWindow_i;
+  delete [] bandBatch;
+  delete [] batchData_f;
+  delete [] batchData_t;
+  delete [] batchPlan;
+  delete [] bandData_f;
+  delete [] bandData_t;
+  delete [] bandWindow_r;
+  delete [] bandWindow_i;
+  delete [] bandNtiles;
+  delete [] bandShift;
+  delete [] bandWindowSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void Oqengine<T>::SetWindows(const double *aWindows){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // input-pruned fft: twiddle factors exp(2*i*pi*k/N) for the largest number of tiles
+  // the numbers of tiles are powers of two: the other batches read the table with a stride
+  int nmax=0;
+  for(int b=0; b<nbatches; b++)
+    if(batchSparseSize[b]) nmax=TMath::Max(nmax,bandNtiles[batchStart[b]]);
+  double *tw_r=NULL, *tw_i=NULL;
+  if(nmax){
+    tw_r = new double [nmax];
+    tw_i = new double [nmax];
+    for(int k=0; k<nmax; k++){
+      tw_r[k]=cos(2.0*TMath::Pi()*(double)k/(double)nmax);
+      tw_i[k]=sin(2.0*TMath::Pi()*(double)k/(double)nmax);
+    }
+  }
+
+  long int offset=0;
+  int n, w, end, nneg, stride, k;
+  const double *window_r, *window_i;
+  double wr, wi;
+  for(int f=0; f<nbands; f++){
+    w=bandWindowSize[f];
+    window_r=aWindows+offset;
+    window_i=aWindows+offset+w;
+    offset+=2*w;
+    for(k=0; k<w; k++){
+      bandWindow_r[f][k]=(T)window_r[k];
+      bandWindow_i[f][k]=(T)window_i[k];
+    }
+
+    // input-pruned fft: window samples from the first negative frequency and twiddle factors
+    // m<W<=L and p<N/L: m*p<N, no modulo
+    if(bandSparseWindow_r[f]==NULL) continue;
+    n=bandNtiles[f];
+    end=(w+1)/2;
+    nneg=(w-1)/2;
+    stride=nmax/n;
+    for(int p=0; p<n/batchSparseSize[bandBatch[f]]; p++){
+      for(int m=0; m<w; m++){
+        if(m<nneg){ wr=window_r[m+end]; wi=window_i[m+end]; }
+        else{ wr=window_r[m-nneg]; wi=window_i[m-nneg]; }
+        k=m*p*stride;
+        bandSparseWindow_r[f][p*w+m]=(T)(wr*tw_r[k]-wi*tw_i[k]);
+        bandSparseWindow_i[f][p*w+m]=(T)(wi*tw_r[k]+wr*tw_i[k]);
+      }
+    }
+  }
+
+  delete [] tw_r;
+  delete [] tw_i;
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void Oqengine<T>::Window(const int aBandIndex, const T *aDataRe, const T *aDataIm){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // locals
+  int f=aBandIndex;
+  int Nt=bandNtiles[f];
+  int Pql=bandShift[f];
+  int W=bandWindowSize[f];
+  int end, nneg, k;
+
+  // input-pruned fft: one sequence per twiddle factor
+  if(batchMode[bandBatch[f]]==2){
+    int lsize=batchSparseSize[bandBatch[f]];
+    nneg=(W-1)/2;
+    for(int p=0; p<Nt/lsize; p++)
+      SimdComplexMultiply(W, (T*)(bandData_f[f]+p*lsize),
+                          bandSparseWindow_r[f]+p*W, bandSparseWindow_i[f]+p*W,
+                          aDataRe+Pql-nneg, aDataIm+Pql-nneg);
+    return;
+  }
+
+  // positive frequencies
+  end=(W+1)/2;
+  SimdComplexMultiply(end, (T*)bandData_f[f],
+                      bandWindow_r[f], bandWindow_i[f],
+                      aDataRe+Pql, aDataIm+Pql);
+
+  // negative frequencies
+  // the zeros in between were set in the constructor
+  nneg=(W-1)/2;
+  if(Pql>=nneg){// always true for Q>=sqrt(11): contiguous data
+    SimdComplexMultiply(nneg, (T*)(bandData_f[f]+Nt-nneg),
+                        bandWindow_r[f]+end, bandWindow_i[f]+end,
+                        aDataRe+Pql-nneg, aDataIm+Pql-nneg);
+  }
+  else{
+    for(k=Nt-nneg; k<Nt; k++){
+      bandData_f[f][k][0]=bandWindow_r[f][k-Nt+W]*aDataRe[abs(Nt-k-Pql)] - bandWindow_i[f][k-Nt+W]*aDataIm[abs(Nt-k-Pql)];
+      bandData_f[f][k][1]=bandWindow_i[f][k-Nt+W]*aDataRe[abs(Nt-k-Pql)] + bandWindow_r[f][k-Nt+W]*aDataIm[abs(Nt-k-Pql)];
+    }
+  }
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void Oqengine<T>::SetOutputRange(const int aBatchIndex, const int aTimeTileStart, const int aTimeTileEnd){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // locals
+  int b=aBatchIndex;
+  int n=bandNtiles[batchStart[b]];
+
+  // save range
+  batchOutStart[b]=TMath::Max(0,aTimeTileStart);
+  batchOutEnd[b]=TMath::Min(n,aTimeTileEnd);
+  if(batchOutEnd[b]<batchOutStart[b]) batchOutEnd[b]=batchOutStart[b];
+
+  // select the cheapest fft
+  int mode=0;
+  double cost=GetFullCost(n);
+  int psize=GetPrunedSize(n, batchOutEnd[b]-batchOutStart[b]);
+  if(psize){
+    mode=1;
+    cost=GetPrunedCost(n, batchOutEnd[b]-batchOutStart[b], psize);
+  }
+  if(batchSparseSize[b]){
+    int wmax=0;
+    for(int f=batchStart[b]; f<batchStart[b]+batchSize[b]; f++) wmax=TMath::Max(wmax,bandWindowSize[f]);
+    if(GetSparseCost(n, batchSparseSize[b], wmax)<cost) mode=2;
+  }
+  if(mode!=1) psize=0;
+
+  // the input vectors are arranged differently for the input-pruned fft: the zeros are restored
+  // (the windowed data are written again for every projection)
+  if((mode==2)!=(batchMode[b]==2)){
+    for(int k=0; k<batchSize[b]*n; k++){
+      batchData_f[b][k][0]=0.0; batchData_f[b][k][1]=0.0;
+    }
+  }
+  batchMode[b]=mode;
+  batchPrunedSize[b]=psize;
+  if(!psize) return;
+
+  // pruned fft output and twiddle factors: allocated once
+  if(batchPrunedData[b]==NULL){
+    batchPrunedData[b] = Offtw<T>::Malloc(batchSize[b]*n);
+    batchTwiddle[b]    = Offtw<T>::Malloc(n);
+    for(int k=0; k<n; k++){
+      batchTwiddle[b][k][0]=(T)cos(2.0*TMath::Pi()*(double)k/(double)n);
+      batchTwiddle[b][k][1]=(T)sin(2.0*TMath::Pi()*(double)k/(double)n);
+    }
+  }
+
+  // pruned fft plan: the plans are kept for each pruned size (powers of 2)
+  // (the output range changes with every injection of a campaign: no re-planning)
+  int l=0;
+  while((1<<l)<psize) l++;
+  batchPrunedPlan[b]=batchPrunedPlans[b][l];
+  if(batchPrunedPlan[b]!=NULL) return;
+  batchPrunedPlan[b] = batchPrunedPlans[b][l] = Offtw<T>::PlanPruned(psize, n/psize, batchSize[b], n, batchData_f[b], batchPrunedData[b], planFlag|FFTW_PRESERVE_INPUT);
+
+  // the input vectors may have been overwritten when planning: the zeros are restored
+  // (the windowed data are written again for every projection)
+  for(int k=0; k<batchSize[b]*n; k++){
+    batchData_f[b][k][0]=0.0; batchData_f[b][k][1]=0.0;
+  }
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void Oqengine<T>::Clear(const int aBatchIndex){
+////////////////////////////////////////////////////////////////////////////////////
+  int n=batchSize[aBatchIndex]*bandNtiles[batchStart[aBatchIndex]];
+  for(int k=0; k<n; k++){
+    batchData_t[aBatchIndex][k][0]=0.0;
+    batchData_t[aBatchIndex][k][1]=0.0;
+  }
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void Oqengine<T>::Execute(const int aBatchIndex){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // full fft
+  if(batchMode[aBatchIndex]==0){
+    Offtw<T>::Execute(batchPlan[aBatchIndex]);
+    return;
+  }
+
+  // input-pruned fft
+  if(batchMode[aBatchIndex]==2){
+    Offtw<T>::Execute(batchSparsePlan[aBatchIndex]);
+    return;
+  }
+
+  // M ffts of size P
+  Offtw<T>::Execute(batchPrunedPlan[aBatchIndex]);
+
+  // locals
+  int b=aBatchIndex;
+  int n=bandNtiles[batchStart[b]];
+  int psize=batchPrunedSize[b];
+  int mask=n-1;
+  int pmask=psize-1;
+  int t, k;
+  typename Offtw<T>::Complex *y, *x;
+  typename Offtw<T>::Complex *tw=batchTwiddle[b];
+
+  // combine the M outputs for the requested time tiles
+  for(int f=batchStart[b]; f<batchStart[b]+batchSize[b]; f++){
+    y=batchPrunedData[b]+(f-batchStart[b])*n;
+    x=bandData_t[f];
+
+    // a=0
+    for(t=batchOutStart[b]; t<batchOutEnd[b]; t++){
+      x[t][0]=y[t&pmask][0];
+      x[t][1]=y[t&pmask][1];
+    }
+
+    // a>0
+    for(int a=1; a<n/psize; a++){
+      y+=psize;
+      k=(int)(((long int)a*(long int)batchOutStart[b])&(long int)mask);
+      for(t=batchOutStart[b]; t<batchOutEnd[b]; t++){
+        x[t][0]+=tw[k][0]*y[t&pmask][0] - tw[k][1]*y[t&pmask][1];
+        x[t][1]+=tw[k][0]*y[t&pmask][1] + tw[k][1]*y[t&pmask][0];
+        k=(k+a)&mask;
+      }
+    }
+  }
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+int Oqengine<T>::GetPrunedSize(const int aNtiles, const int aNout){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // cost model: see GetFullCost() and GetPrunedCost()
+  double cost=GetFullCost(aNtiles);
+  int psize=0;
+  for(int p=1; p<aNtiles; p*=2){
+    if(GetPrunedCost(aNtiles,aNout,p)<cost){
+      cost=GetPrunedCost(aNtiles,aNout,p);
+      psize=p;
+    }
+  }
+
+  return psize;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+double Oqengine<T>::GetFullCost(const int aNtiles){
+////////////////////////////////////////////////////////////////////////////////////
+  return 5.0*(double)aNtiles*log2((double)aNtiles);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+double Oqengine<T>::GetPrunedCost(const int aNtiles, const int aNout, const int aPrunedSize){
+////////////////////////////////////////////////////////////////////////////////////
+  // M ffts of size P + combination of n output tiles (counted twice: no SIMD)
+  return 5.0*(double)aNtiles*log2((double)aPrunedSize)+16.0*(double)aNtiles/(double)aPrunedSize*(double)aNout;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+double Oqengine<T>::GetSparseCost(const int aNtiles, const int aSparseSize, const int aWindowSize){
+////////////////////////////////////////////////////////////////////////////////////
+  // K ffts of size L + K-1 additional windowing
+  return 5.0*(double)aNtiles*log2((double)aSparseSize)+6.0*(double)(aNtiles/aSparseSize-1)*(double)aWindowSize;
+}
+
+#endif
@@ -8,7 +8,9 @@ ClassImp(Oqplane)
 ////////////////////////////////////////////////////////////////////////////////////
 Oqplane::Oqplane(const double aQ, const int aSampleFrequency, const int aTimeRange, 
 		 const double aFrequencyMin, const double aFrequencyMax, 
-		 const double aMismatchStep): Omap(){ 
+		 const double aMismatchStep, const string aFftPlan,
+		 const string aPrecision, const bool aSparse,
+		 const double *aWindows, const long int aWindowsSize): Omap(){ 
 ////////////////////////////////////////////////////////////////////////////////////
   
   // save parameters
@@ -46,8 +48,7 @@ Oqplane::Oqplane(const double aQ, const int aSampleFrequency, const int aTimeRan
   // Q plane definition
   ostringstream titlestream;
   titlestream<<"qplane_"<<setprecision(5)<<fixed<<Q;
-  SetName(titlestream.str().c_str());
-  SetTitle(titlestream.str().c_str());
+  SetName(titlestream.str());
   titlestream.str(""); titlestream.clear();
   
   // set binning
@@ -58,65 +59,153 @@ Oqplane::Oqplane(const double aQ, const int aSampleFrequency, const int aTimeRan
 
   // band variables
   bandNoiseAmplitude = new double  [GetNBands()];
-  bandFFT            = new fft*    [GetNBands()];
-  bandWindow_r       = new double* [GetNBands()];
-  bandWindow_i       = new double* [GetNBands()];
   bandWindowSize     = new int     [GetNBands()];
+  bandPowerWindow    = new double* [GetNBands()];
+  bandPowerStart     = new int     [GetNBands()];
+  bandPowerFrac      = new double  [GetNBands()];
+  int *bandntiles    = new int     [GetNBands()];
+  int *bandshift     = new int     [GetNBands()];
   
-  double windowargument;
-  double winnormalization;
-  double ifftnormalization;
   double delta_f;// Connes window 1/2-width
-  int k, end;
   //double A1 = GetA1(); // not used
    
   for(int f=0; f<GetNBands(); f++){
     
     // no power
     bandNoiseAmplitude[f]=0.0;
-            
-    // band fft
-    ifftnormalization = 1.0 / (double)TimeRange;
-    bandFFT[f] = new fft(GetBandNtiles(f),"FFTW_ESTIMATE", "c2c");
 
-    // Prepare window stuff
+    // window size
     delta_f=GetBandFrequency(f)/QPrime;// from eq. 5.18
     bandWindowSize[f] = 2 * (int)floor(delta_f*(double)TimeRange) + 1;
-    bandWindow_r[f]   = new double [bandWindowSize[f]];
-    bandWindow_i[f]   = new double [bandWindowSize[f]];
-    winnormalization  = sqrt(315.0*QPrime/128.0/GetBandFrequency(f));// eq. 5.26 Localized bursts only!!!
-
-    // bisquare window
-    end=(bandWindowSize[f]+1)/2;
-    for(k=0; k<end; k++){
-      windowargument=2.0*(double)k/(double)(bandWindowSize[f] - 1);
-      bandWindow_r[f][k] = winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Cos(TMath::Pi()*(double)k/(double)GetBandNtiles(f));// bisquare window (1-x^2)^2 and phase shift
-      bandWindow_i[f][k] = winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Sin(TMath::Pi()*(double)k/(double)GetBandNtiles(f));// bisquare window (1-x^2)^2 and phase shift
+
+    // squared window to average the noise power (eq. 5.28)
+    // the window frequencies are shifted from the frequency bins (1/TimeRange) by a constant fraction of a bin
+    double x = GetBandFrequency(f)*(double)TimeRange - (double)((bandWindowSize[f]-1)/2);
+    double Wb = sqrt(315.0/128.0*QPrime/GetBandFrequency(f));
+    double arg;
+    bandPowerStart[f] = (int)floor(x);
+    bandPowerFrac[f] = x - (double)bandPowerStart[f];
+    bandPowerWindow[f] = new double [bandWindowSize[f]];
+    for(int k=0; k<bandWindowSize[f]; k++){
+      arg = (double)(k-(bandWindowSize[f]-1)/2)/(double)TimeRange/delta_f;
+      arg = Wb*(1.0-arg*arg)*(1.0-arg*arg);
+      bandPowerWindow[f][k] = arg*arg/2.0/(double)TimeRange;
     }
-    // do not save 0s in the center
-    end=bandWindowSize[f];
-    for(; k<end; k++){
-      windowargument=2.0*(double)(k-end)/(double)(bandWindowSize[f] - 1);
-      bandWindow_r[f][k] = -winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Cos(TMath::Pi()*(double)(k-bandWindowSize[f]+GetBandNtiles(f))/(double)GetBandNtiles(f));// bisquare window (1-x^2)^2 and phase shift
-      bandWindow_i[f][k] = -winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Sin(TMath::Pi()*(double)(k-bandWindowSize[f]+GetBandNtiles(f))/(double)GetBandNtiles(f));// bisquare window (1-x^2)^2 and phase shift
+
+    // number of tiles in this row
+    bandntiles[f] = GetBandNtiles(f);
+
+    // frequency index shift for this row
+    bandshift[f] = (int)floor(GetBandFrequency(f)*GetTimeRange());
+  }
+
+  // band batches: contiguous bands with the same number of tiles
+  batchStart = new int [GetNBands()];
+  batchSize  = new int [GetNBands()];
+  bandBatch  = new int [GetNBands()];
+  nbatches=0;
+  for(int f=0; f<GetNBands(); f++){
+    if(nbatches&&
+       GetBandNtiles(f)==GetBandNtiles(batchStart[nbatches-1])&&
+       (batchSize[nbatches-1]+1)*GetBandNtiles(f)<=BATCHSIZEMAX){
+      batchSize[nbatches-1]++;
+      bandBatch[f]=nbatches-1;
+      continue;
     }
+    batchStart[nbatches]=f;
+    batchSize[nbatches]=1;
+    bandBatch[f]=nbatches;
+    nbatches++;
+  }
+  batchSNRDeviation = new double [nbatches];
+  batchTileStart    = new int [nbatches];
+  batchTileEnd      = new int [nbatches];
+  batchSkip         = new bool [nbatches];
+  for(int b=0; b<nbatches; b++){
+    batchSNRDeviation[b]=0.0;
+    batchSkip[b]=false;
+    batchTileStart[b]=0;
+    batchTileEnd[b]=GetBandNtiles(batchStart[b]);
+  }
+
+  // tiles above threshold (nothing projected yet)
+  bandTiles        = new vector <Oqtile> [GetNBands()];
+  bandTilesStart   = new int [GetNBands()];
+  bandTilesEnd     = new int [GetNBands()];
+  bandTilesSNRThr2 = new double [GetNBands()];
+  for(int f=0; f<GetNBands(); f++){
+    bandTilesStart[f]=0;
+    bandTilesEnd[f]=0;
+    bandTilesSNRThr2[f]=0.0;
   }
+
+  // projection engines
+  precision=aPrecision;
+  if(precision.compare("single")&&precision.compare("validate")) precision="double";
+  unsigned int planflag = GetFftPlanFlag(aFftPlan);
+  engine=NULL; enginef=NULL;
+  if(precision.compare("single"))
+    engine = new Oqengine<double>(GetNBands(), bandntiles, bandshift, bandWindowSize, nbatches, batchStart, batchSize, planflag, aSparse);
+  if(precision.compare("double"))
+    enginef = new Oqengine<float>(GetNBands(), bandntiles, bandshift, bandWindowSize, nbatches, batchStart, batchSize, planflag, aSparse);
+  delete [] bandntiles;
+  delete [] bandshift;
+
+  // band windows: precomputed (tiling cache) or computed here
+  if(aWindows!=NULL&&aWindowsSize!=GetWindowsSize()){
+    cerr<<"Oqplane::Oqplane: the precomputed windows do not match the Q-plane --> compute the windows"<<endl;
+    aWindows=NULL;
+  }
+  double *windows=NULL;
+  if(aWindows==NULL){
+    windows = new double [GetWindowsSize()];
+    GetWindows(windows);
+    aWindows=windows;
+  }
+
+  // windows are owned by the engines
+  // the window modulus is kept to bound the tile energy
+  if(engine!=NULL)  engine->SetWindows(aWindows);
+  if(enginef!=NULL) enginef->SetWindows(aWindows);
+  long int offset=0;
+  bandWindowAbs = new double* [GetNBands()];
+  bandBelow     = new bool [GetNBands()];
+  for(int f=0; f<GetNBands(); f++){
+    bandWindowAbs[f] = new double [bandWindowSize[f]];
+    for(int k=0; k<bandWindowSize[f]; k++)
+      bandWindowAbs[f][k]=sqrt(aWindows[offset+k]*aWindows[offset+k]+aWindows[offset+bandWindowSize[f]+k]*aWindows[offset+bandWindowSize[f]+k]);
+    bandBelow[f]=false;
+    offset+=2*bandWindowSize[f];
+  }
+  delete [] windows;
   
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
 Oqplane::~Oqplane(void){
 ////////////////////////////////////////////////////////////////////////////////////
-  for(int f=0; f<GetNBands(); f++){
-    delete bandFFT[f];
-    delete bandWindow_r[f];
-    delete bandWindow_i[f];
-  }
+  if(engine!=NULL) delete engine;
+  if(enginef!=NULL) delete enginef;
+  delete [] batchStart;
+  delete [] batchSize;
+  delete [] bandBatch;
+  delete [] batchSNRDeviation;
+  delete [] batchTileStart;
+  delete [] batchTileEnd;
+  delete [] batchSkip;
+  delete [] bandTiles;
+  delete [] bandTilesStart;
+  delete [] bandTilesEnd;
+  delete [] bandTilesSNRThr2;
+  for(int f=0; f<GetNBands(); f++) delete [] bandWindowAbs[f];
+  delete [] bandWindowAbs;
+  delete [] bandBelow;
   delete bandWindowSize;
-  delete bandFFT;
+  for(int f=0; f<GetNBands(); f++) delete [] bandPowerWindow[f];
+  delete [] bandPowerWindow;
+  delete [] bandPowerStart;
+  delete [] bandPowerFrac;
   delete bandNoiseAmplitude;
-  delete bandWindow_r;
-  delete bandWindow_i;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -147,7 +236,7 @@ void Oqplane::FillMap(const string aContentType, const double aTimeStart, const
       tstart=Omap::GetTimeTileIndex(f,aTimeStart);
       tend=Omap::GetTimeTileIndex(f,aTimeEnd);
       for(int t=tstart; t<=tend; t++)
-	SetTileContent(t,f,bandFFT[f]->GetPhase_t(t));
+	SetTileContent(t,f,GetTilePhase(t,f));
     }
   }
   else{
@@ -170,7 +259,7 @@ bool Oqplane::SaveTriggers(TriggerBuffer *aTriggers, // trigger structure
 			   ){
 ////////////////////////////////////////////////////////////////////////////////////
   int tstart, tend;
-  double snr2, snr;
+  double snr2;
   double SNRThr2 = SNRThr*SNRThr;
   
   for(int f=0; f<GetNBands(); f++){
@@ -182,7 +271,21 @@ bool Oqplane::SaveTriggers(TriggerBuffer *aTriggers, // trigger structure
     // enforce GWOLLUM convention
     if(GetTileTime(tend,f)<aSeg->GetEnd(aSeg->GetNsegments()-1)-aT0) tend++;
 
-    // fill triggers
+    // fill triggers from the tiles above threshold listed during the projection
+    if(tstart>=bandTilesStart[f]&&tend<=bandTilesEnd[f]&&SNRThr2>=bandTilesSNRThr2[f]){
+      for(int i=0; i<(int)bandTiles[f].size(); i++){
+        if(bandTiles[f][i].t<tstart) continue;
+        if(bandTiles[f][i].t>=tend) break;
+        if(bandTiles[f][i].snr2<SNRThr2) continue;
+        if(!SaveTrigger(aTriggers, aT0, aSeg, bandTiles[f][i].t, f, bandTiles[f][i].snr2, bandTiles[f][i].phase)) return false;
+      }
+      continue;
+    }
+
+    // fill triggers: scan all tiles
+    // only the tiles of the projection window were computed (the others are from a previous projection)
+    tstart=TMath::Max(tstart,batchTileStart[bandBatch[f]]);
+    tend=TMath::Min(tend,batchTileEnd[bandBatch[f]]);
     for(int t=tstart; t<tend; t++){
 
       // get tile snr
@@ -191,25 +294,7 @@ bool Oqplane::SaveTriggers(TriggerBuffer *aTriggers, // trigger structure
       // apply SNR threshold
       if(snr2<SNRThr2) continue;
 
-      // time select
-      if(!aSeg->IsInsideSegment(GetTileTime(t,f)+aT0)) continue;
-
-      // amplitude SNR
-      snr=sqrt(snr2);
-      
-      // save trigger
-      if(!aTriggers->AddTrigger(GetTileTime(t,f)+aT0,
-				GetBandFrequency(f),
-				snr,
-				Q,
-				GetTileTimeStart(t,f)+aT0,
-				GetTileTimeEnd(t,f)+aT0,
-				GetBandStart(f),
-				GetBandEnd(f),
-				snr*bandNoiseAmplitude[f],
-				//bandFFT[f]->GetNorm2_t(t),
-				bandFFT[f]->GetPhase_t(t)))
-	return false;
+      if(!SaveTrigger(aTriggers, aT0, aSeg, t, f, snr2, GetTilePhase(t,f))) return false;
     }
   }
 
@@ -218,58 +303,171 @@ bool Oqplane::SaveTriggers(TriggerBuffer *aTriggers, // trigger structure
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
-int Oqplane::ProjectData(fft *aDataFft, const double aPadding){
+bool Oqplane::SaveTrigger(TriggerBuffer *aTriggers, const double aT0, Segments* aSeg,
+                          const int aTimeTileIndex, const int aBandIndex,
+                          const double aSNR2, const double aPhase){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // time select
+  if(!aSeg->IsInsideSegment(GetTileTime(aTimeTileIndex,aBandIndex)+aT0)) return true;
+
+  // amplitude SNR
+  double snr=sqrt(aSNR2);
+      
+  // save trigger
+  return aTriggers->AddTrigger(GetTileTime(aTimeTileIndex,aBandIndex)+aT0,
+                               GetBandFrequency(aBandIndex),
+                               snr,
+                               Q,
+                               GetTileTimeStart(aTimeTileIndex,aBandIndex)+aT0,
+                               GetTileTimeEnd(aTimeTileIndex,aBandIndex)+aT0,
+                               GetBandStart(aBandIndex),
+                               GetBandEnd(aBandIndex),
+                               snr*bandNoiseAmplitude[aBandIndex],
+                               //GetTileNorm2(t,f),
+                               aPhase);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+int Oqplane::ProjectData(const double *aDataRe, const double *aDataIm,
+                         const float *aDataRef, const float *aDataImf,
+                         const double *aDataAbs, const double aPadding){
 ////////////////////////////////////////////////////////////////////////////////////
 
-  // locals
-  int k, Pql, Nt, end, tstart, tend;
-  double snrthr2=SNRThr*SNRThr;
   int nt=0; //number of tiles above threshold
    
-  // loop over frequency bands
-  for(int f=0; f<GetNBands(); f++){
-
-    // number of tiles in this row
-    Nt = GetBandNtiles(f);
+  // loop over band batches
+  for(int b=0; b<nbatches; b++) nt+=ProjectBatch(b, aDataRe, aDataIm, aDataRef, aDataImf, aDataAbs, aPadding);
+ 
+  return nt;
+}
 
-    // frequency index shift for this row
-    Pql=(int)floor(GetBandFrequency(f)*GetTimeRange());
+////////////////////////////////////////////////////////////////////////////////////
+int Oqplane::ProjectBatch(const int aBatchIndex,
+                          const double *aDataRe, const double *aDataIm,
+                          const float *aDataRef, const float *aDataImf,
+                          const double *aDataAbs, const double aPadding){
+////////////////////////////////////////////////////////////////////////////////////
 
-    // populate \tilde{v}
-    end=(bandWindowSize[f]+1)/2;
-    for(k=0; k<end; k++){
-      bandFFT[f]->SetRe_f(k,bandWindow_r[f][k]*aDataFft->GetRe_f(k+Pql) - bandWindow_i[f][k]*aDataFft->GetIm_f(k+Pql));
-      bandFFT[f]->SetIm_f(k,bandWindow_i[f][k]*aDataFft->GetRe_f(k+Pql) + bandWindow_r[f][k]*aDataFft->GetIm_f(k+Pql));
-    }
-    end=Nt-(bandWindowSize[f]-1)/2;
-    for(; k<end; k++){
-      bandFFT[f]->SetRe_f(k,0.0);
-      bandFFT[f]->SetIm_f(k,0.0);
+  // locals
+  int tstart, tend;
+  double snrthr2=SNRThr*SNRThr;
+  int nt=0; //number of tiles above threshold
+  Oqtile tile;
+  int fstart=batchStart[aBatchIndex];
+  int fend=batchStart[aBatchIndex]+batchSize[aBatchIndex];
+
+  // energy bound: bands which cannot have a tile above threshold
+  bool above=true;
+  if(aDataAbs!=NULL){
+    above=false;
+    for(int f=fstart; f<fend; f++){
+      bandBelow[f]=(GetEnergyBound(f, aDataAbs)-2.0<snrthr2);
+      if(!bandBelow[f]) above=true;
     }
-    end=Nt;
-    for(; k<end; k++){
-      bandFFT[f]->SetRe_f(k,bandWindow_r[f][k-Nt+bandWindowSize[f]]*(aDataFft->GetRe_f(abs(Nt-k-Pql))) - bandWindow_i[f][k-Nt+bandWindowSize[f]]*(aDataFft->GetIm_f(abs(Nt-k-Pql))));
-      bandFFT[f]->SetIm_f(k,bandWindow_r[f][k-Nt+bandWindowSize[f]]*(aDataFft->GetIm_f(abs(Nt-k-Pql))) + bandWindow_i[f][k-Nt+bandWindowSize[f]]*(aDataFft->GetRe_f(abs(Nt-k-Pql))));
- 
+  }
+  else{
+    for(int f=fstart; f<fend; f++) bandBelow[f]=false;
+  }
+
+  // batch not selected by the coarse search or below threshold: no tiles
+  if(batchSkip[aBatchIndex]||!above){
+    if(engine!=NULL)  engine->Clear(aBatchIndex);
+    if(enginef!=NULL) enginef->Clear(aBatchIndex);
+    batchSNRDeviation[aBatchIndex]=0.0;
+    for(int f=fstart; f<fend; f++){
+      bandTiles[f].clear();
+      bandTilesStart[f]=0;
+      bandTilesEnd[f]=GetBandNtiles(f);
+      bandTilesSNRThr2[f]=0.0;
     }
+    return 0;
+  }
 
-    // fft-backward
-    bandFFT[f]->Backward();
-    // note the FFT normalization was already included in the window definition
+  // populate \tilde{v} for each band and fft-backward (all bands of the batch)
+  // note the FFT normalization was already included in the window definition
+  if(engine!=NULL){
+    for(int f=fstart; f<fend; f++) engine->Window(f, aDataRe, aDataIm);
+    engine->Execute(aBatchIndex);
+  }
+  if(enginef!=NULL){
+    for(int f=fstart; f<fend; f++) enginef->Window(f, aDataRef, aDataImf);
+    enginef->Execute(aBatchIndex);
+  }
 
-    // from now on, the final Q coefficients are stored in the time vector of bandFFT[f]
+  // from now on, the final Q coefficients are stored in the engine
+
+  // list and count tiles above threshold
+  // the list includes one extra tile at the end (see SaveTriggers())
+  batchSNRDeviation[aBatchIndex]=0.0;
+  for(int f=fstart; f<fend; f++){
+    tstart=TMath::Max(GetTimeTileIndex(f, GetTimeMin()+aPadding),batchTileStart[aBatchIndex]);
+    tend=TMath::Min(GetTimeTileIndex(f, GetTimeMax()-aPadding),batchTileEnd[aBatchIndex]);
+    bandTiles[f].clear();
+    bandTilesStart[f]=tstart;
+    bandTilesEnd[f]=TMath::Min(tend+1,batchTileEnd[aBatchIndex]);
+    bandTilesSNRThr2[f]=snrthr2;
+    if(bandBelow[f]) continue;// no tile above threshold
+    for(int t=tstart; t<bandTilesEnd[f]; t++){
+      tile.snr2=GetTileSNR2(t,f);
+      if(tile.snr2<snrthr2) continue;
+      tile.t=t;
+      tile.phase=GetTilePhase(t,f);
+      bandTiles[f].push_back(tile);
+      if(t<tend) nt++;
+    }
 
-    // count tiles above threshold
-    tstart=GetTimeTileIndex(f, GetTimeMin()+aPadding);
-    tend=GetTimeTileIndex(f, GetTimeMax()-aPadding);
-    for(int t=tstart; t<tend; t++){
-      if(GetTileSNR2(t,f)>=snrthr2) nt++;
+    // validation: compare single and double precision
+    if(engine!=NULL&&enginef!=NULL){
+      for(int t=tstart; t<tend; t++)
+        batchSNRDeviation[aBatchIndex]=TMath::Max(batchSNRDeviation[aBatchIndex],
+                                                  fabs(sqrt(GetTileSNR2(t,f))-sqrt(TMath::Max(enginef->GetNorm2(t,f)-2.0,0.0))));
     }
   }
  
   return nt;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+void Oqplane::SetProjectionWindow(const double aTimeStart, const double aTimeEnd){
+////////////////////////////////////////////////////////////////////////////////////
+  int f;
+  for(int b=0; b<nbatches; b++){
+    f=batchStart[b];// same time tiling for all the bands of a batch
+    batchTileStart[b]=TMath::Max(0,GetTimeTileIndex(f, aTimeStart));
+    batchTileEnd[b]=TMath::Min(GetBandNtiles(f),GetTimeTileIndex(f, aTimeEnd)+1);
+    if(batchTileEnd[b]<batchTileStart[b]) batchTileEnd[b]=batchTileStart[b];
+    if(engine!=NULL)  engine->SetOutputRange(b, batchTileStart[b], batchTileEnd[b]);
+    if(enginef!=NULL) enginef->SetOutputRange(b, batchTileStart[b], batchTileEnd[b]);
+  }
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+double Oqplane::GetSNRDeviation(void){
+////////////////////////////////////////////////////////////////////////////////////
+  double dev=0.0;
+  for(int b=0; b<nbatches; b++) dev=TMath::Max(dev,batchSNRDeviation[b]);
+  return dev;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+double Oqplane::GetEnergyBound(const int aBandIndex, const double *aDataAbs){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // the tile coefficients are a sum over the windowed data: |x[t]| <= sum_k |w_k|*|d_k|
+  // (same data samples as in Oqengine::Window())
+  int W=bandWindowSize[aBandIndex];
+  int Pql=(int)floor(GetBandFrequency(aBandIndex)*GetTimeRange());
+  int end=(W+1)/2;
+  int k;
+  double sum=0.0;
+  for(k=0; k<end; k++) sum+=bandWindowAbs[aBandIndex][k]*aDataAbs[Pql+k];
+  for(; k<W; k++) sum+=bandWindowAbs[aBandIndex][k]*aDataAbs[abs(Pql-(W-k))];
+
+  return sum*sum;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 double Oqplane::GetMeanEnergy(const int aBandIndex, const double aPadding){
 ////////////////////////////////////////////////////////////////////////////////////
@@ -278,7 +476,7 @@ double Oqplane::GetMeanEnergy(const int aBandIndex, const double aPadding){
   int tstart=GetTimeTileIndex(aBandIndex, GetTimeMin()+aPadding);
   int tend=GetTimeTileIndex(aBandIndex, GetTimeMax()-aPadding);
   vector <double> v;
-  for(int t=tstart; t<tend; t++) v.push_back(bandFFT[aBandIndex]->GetNorm2_t(t));    
+  for(int t=tstart; t<tend; t++) v.push_back(GetTileNorm2(t,aBandIndex));    
 
   // outlier threshold eq. 5.91 with alpha=2.0
   size_t n25 = 1*v.size() / 4;
@@ -292,8 +490,8 @@ double Oqplane::GetMeanEnergy(const int aBandIndex, const double aPadding){
   double MeanEnergy=0;
   int n=0;
   for(int t=tstart; t<tend; t++){
-    if(bandFFT[aBandIndex]->GetNorm2_t(t)>thr) continue;
-    MeanEnergy+=bandFFT[aBandIndex]->GetNorm2_t(t);    
+    if(GetTileNorm2(t,aBandIndex)>thr) continue;
+    MeanEnergy+=GetTileNorm2(t,aBandIndex);    
     n++;
   }
   if(n){
@@ -306,42 +504,41 @@ double Oqplane::GetMeanEnergy(const int aBandIndex, const double aPadding){
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
-bool Oqplane::SetPower(Spectrum *aSpec1, Spectrum *aSpec2){
+void Oqplane::SetPower(const double *aPower1, const double *aPower2, double *aWork, const int *aDriftCount){
 ////////////////////////////////////////////////////////////////////////////////////
-
-  //double sumofweight;
-  double sum, Wb, deltaf, freq, win;
-  int i, end;
-  
-  double dfreq=1.0 / GetTimeRange();
+  int i0, W;
+  double a, p1, p2;
 
   // set power for each f-row
   for(int f=0; f<GetNBands(); f++){
-    sum=0;
-    Wb = sqrt(315.0/128.0*QPrime/GetBandFrequency(f));
-    deltaf = GetBandFrequency(f) / QPrime;
-    i=0;
-
-    // f > phi
-    end=(bandWindowSize[f]+1)/2;
-    for(; i<end; i++){
-      freq=GetBandFrequency(f)+ (double)i / GetTimeRange();
-      win = Wb * (1.0-(freq-GetBandFrequency(f))*(freq-GetBandFrequency(f))/deltaf/deltaf) * (1.0-(freq-GetBandFrequency(f))*(freq-GetBandFrequency(f))/deltaf/deltaf);
-      sum += win*win /2.0 /sqrt(aSpec1->GetPower(freq)*aSpec2->GetPower(freq)/4.0) * dfreq;
+    i0=bandPowerStart[f];
+    W=bandWindowSize[f];
+
+    // the power did not change over the window
+    if(aDriftCount!=NULL&&aDriftCount[i0+W+1]==aDriftCount[i0]) continue;
+
+    // inverse noise amplitude at the window frequencies
+    // the noise powers are linearly interpolated between bins (as in the Spectrum class)
+    a=bandPowerFrac[f];
+    for(int k=0; k<W; k++){
+      p1=(1.0-a)*aPower1[i0+k]+a*aPower1[i0+k+1];
+      p2=(1.0-a)*aPower2[i0+k]+a*aPower2[i0+k+1];
+      aWork[k]=1.0/sqrt(p1*p2/4.0);
     }
 
-    // f < phi
-    end=bandWindowSize[f];
-    for(; i<end; i++){
-      freq=GetBandFrequency(f)-(double)(end-i) / GetTimeRange();
-      win = Wb * (1.0-(freq-GetBandFrequency(f))*(freq-GetBandFrequency(f))/deltaf/deltaf) * (1.0-(freq-GetBandFrequency(f))*(freq-GetBandFrequency(f))/deltaf/deltaf);
-      sum += win*win /2.0 /sqrt(aSpec1->GetPower(freq)*aSpec2->GetPower(freq)/4.0) * dfreq;
-    }
-        
-    bandNoiseAmplitude[f]=1.0/sum;
+    // squared window x inverse noise amplitude
+    bandNoiseAmplitude[f]=1.0/SimdDot(W, bandPowerWindow[f], aWork);
   }
-  
-  return true;
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+int Oqplane::GetPowerSize(void){
+////////////////////////////////////////////////////////////////////////////////////
+  int size=0;
+  for(int f=0; f<GetNBands(); f++) size=TMath::Max(size, bandPowerStart[f]+bandWindowSize[f]+1);
+  return size;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -365,6 +562,17 @@ double Oqplane::GetA1(void){
   return sqrt(256.0 / 315.0 / QPrime / a);
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+unsigned int Oqplane::GetFftPlanFlag(const string aFftPlan){
+////////////////////////////////////////////////////////////////////////////////////
+  if(!aFftPlan.compare("FFTW_ESTIMATE"))   return FFTW_ESTIMATE;
+  if(!aFftPlan.compare("FFTW_MEASURE"))    return FFTW_MEASURE;
+  if(!aFftPlan.compare("FFTW_PATIENT"))    return FFTW_PATIENT;
+  if(!aFftPlan.compare("FFTW_EXHAUSTIVE")) return FFTW_EXHAUSTIVE;
+  cerr<<"Oqplane::GetFftPlanFlag: unknown fft plan "<<aFftPlan<<" --> use FFTW_ESTIMATE"<<endl;
+  return FFTW_ESTIMATE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 void Oqplane::PrintParameters(void){
 ////////////////////////////////////////////////////////////////////////////////////
@@ -376,7 +584,57 @@ void Oqplane::PrintParameters(void){
   cout<<"\t- Number of frequency rows  = "<<GetNBands()<<endl;
   cout<<"\t- Frequency resolution      = "<<GetBandWidth(0)<<" Hz - "<<GetBandWidth(GetNBands()-1)<<" Hz"<<endl;
   cout<<"\t- Number of tiles           = "<<Ntiles<<endl;
-  cout<<"\t- Number of bins (internal) = "<<GetNbinsX()*GetNBands()<<endl;
+  cout<<"\t- Number of fft batches     = "<<nbatches<<endl;
+  cout<<"\t- Precision                 = "<<precision<<endl;
+  cout<<"\t- Number of bins (internal) = "<<(long int)ntbins*(long int)GetNBands()<<endl;
   return;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////////
+void Oqplane::ComputeWindow(const int aBandIndex, double *aWindow_r, double *aWindow_i){
+////////////////////////////////////////////////////////////////////////////////////
+  double windowargument;
+            
+  // band fft normalization
+  double ifftnormalization = 1.0 / (double)GetTimeRange();
+
+  // Prepare window stuff
+  double winnormalization  = sqrt(315.0*QPrime/128.0/GetBandFrequency(aBandIndex));// eq. 5.26 Localized bursts only!!!
+
+  // bisquare window
+  int k, end=(bandWindowSize[aBandIndex]+1)/2;
+  for(k=0; k<end; k++){
+    windowargument=2.0*(double)k/(double)(bandWindowSize[aBandIndex] - 1);
+    aWindow_r[k] = winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Cos(TMath::Pi()*(double)k/(double)GetBandNtiles(aBandIndex));// bisquare window (1-x^2)^2 and phase shift
+    aWindow_i[k] = winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Sin(TMath::Pi()*(double)k/(double)GetBandNtiles(aBandIndex));// bisquare window (1-x^2)^2 and phase shift
+  }
+  // do not save 0s in the center
+  end=bandWindowSize[aBandIndex];
+  for(; k<end; k++){
+    windowargument=2.0*(double)(k-end)/(double)(bandWindowSize[aBandIndex] - 1);
+    aWindow_r[k] = -winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Cos(TMath::Pi()*(double)(k-bandWindowSize[aBandIndex]+GetBandNtiles(aBandIndex))/(double)GetBandNtiles(aBandIndex));// bisquare window (1-x^2)^2 and phase shift
+    aWindow_i[k] = -winnormalization*ifftnormalization*(1.0-windowargument*windowargument)*(1.0-windowargument*windowargument)*TMath::Sin(TMath::Pi()*(double)(k-bandWindowSize[aBandIndex]+GetBandNtiles(aBandIndex))/(double)GetBandNtiles(aBandIndex));// bisquare window (1-x^2)^2 and phase shift
+  }
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+long int Oqplane::GetWindowsSize(void){
+////////////////////////////////////////////////////////////////////////////////////
+  long int size=0;
+  for(int f=0; f<GetNBands(); f++) size+=2*bandWindowSize[f];
+  return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Oqplane::GetWindows(double *aWindows){
+////////////////////////////////////////////////////////////////////////////////////
+  long int offset=0;
+  for(int f=0; f<GetNBands(); f++){
+    ComputeWindow(f, aWindows+offset, aWindows+offset+bandWindowSize[f]);
+    offset+=2*bandWindowSize[f];
+  }
+  return;
+}
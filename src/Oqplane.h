@@ -7,12 +7,26 @@
 #include <TriggerBuffer.h>
 #include <Spectrum.h>
 #include "Omap.h"
+#include "Oqengine.h"
 
 // eq 5.95 with alpha=2
 #define BIASFACT2 1.1140649371721838001292326225666329264640808105469
 
+// maximum number of complex values in a batch of band ffts
+#define BATCHSIZEMAX 32768
+
 using namespace std;
 
+/**
+ * Tile above the SNR threshold.
+ * The tiles above threshold are listed for each frequency band when projecting the data.
+ */
+struct Oqtile {
+  int t;                            ///< time tile index
+  double snr2;                      ///< tile SNR^2
+  double phase;                     ///< tile phase
+};
+
 /**
  * Create a time-frequency Q-plane.
  * This class was designed to create and use a time-frequency Q-plane defined by a Q value. This class is entirely private and can only be used through the Otile class.
@@ -32,32 +46,64 @@ class Oqplane: public Omap {
 	  const int aTimeRange, 
 	  const double aFrequencyMin, 
 	  const double aFrequencyMax, 
-	  const double aMismatchStep);
+	  const double aMismatchStep,
+	  const string aFftPlan="FFTW_ESTIMATE",
+	  const string aPrecision="double",
+	  const bool aSparse=false,
+	  const double *aWindows=NULL,
+	  const long int aWindowsSize=0);
   virtual ~Oqplane(void);
 
   void PrintParameters(void);
-  int ProjectData(fft *aDataFft, const double aPadding=0.0);
+  int ProjectData(const double *aDataRe, const double *aDataIm,
+                  const float *aDataRef, const float *aDataImf,
+                  const double *aDataAbs, const double aPadding=0.0);
+  int ProjectBatch(const int aBatchIndex,
+                   const double *aDataRe, const double *aDataIm,
+                   const float *aDataRef, const float *aDataImf,
+                   const double *aDataAbs, const double aPadding=0.0);
+  double GetSNRDeviation(void);
+  void SetProjectionWindow(const double aTimeStart, const double aTimeEnd);
   void FillMap(const string aContentType, const double aTimeStart, const double aTimeEnd);
   bool SaveTriggers(TriggerBuffer *aTriggers, const double aT0, Segments* aSeg);
+  bool SaveTrigger(TriggerBuffer *aTriggers, const double aT0, Segments* aSeg,
+                   const int aTimeTileIndex, const int aBandIndex,
+                   const double aSNR2, const double aPhase);
 
   // GETS
   inline double GetQ(void){ return Q; };
   inline double GetSNRThr(void){ return SNRThr; };
+  inline int GetNBatches(void){ return nbatches; };
+  inline int GetBatchCost(const int aBatchIndex){ return batchSize[aBatchIndex]*GetBandNtiles(batchStart[aBatchIndex]); };
+  long int GetWindowsSize(void);
+  void GetWindows(double *aWindows);
+  inline double GetTileNorm2(const int aTimeTileIndex, const int aBandIndex){
+    if(engine!=NULL) return engine->GetNorm2(aTimeTileIndex,aBandIndex);
+    return enginef->GetNorm2(aTimeTileIndex,aBandIndex);
+  };
   inline double GetTileSNR2(const int aTimeTileIndex, const int aBandIndex){
-    return TMath::Max(bandFFT[aBandIndex]->GetNorm2_t(aTimeTileIndex)-2.0,0.0);
+    return TMath::Max(GetTileNorm2(aTimeTileIndex,aBandIndex)-2.0,0.0);
+  };
+  inline double GetTilePhase(const int aTimeTileIndex, const int aBandIndex){
+    if(engine!=NULL) return engine->GetPhase(aTimeTileIndex,aBandIndex);
+    return enginef->GetPhase(aTimeTileIndex,aBandIndex);
   };
   inline double GetTileAmplitude(const int aTimeTileIndex, const int aBandIndex){
     return sqrt(GetTileSNR2(aTimeTileIndex,aBandIndex))*bandNoiseAmplitude[aBandIndex];
   };
 
   // SETS
-  bool SetPower(Spectrum *aSpec1, Spectrum *aSpec2);
+  void SetPower(const double *aPower1, const double *aPower2, double *aWork, const int *aDriftCount=NULL);
   inline void SetSNRThr(const double aSNRThr){ SNRThr=aSNRThr; };
 
 
   // INTERNAL
   double GetMeanEnergy(const int aBandIndex, const double aPadding);
+  double GetEnergyBound(const int aBandIndex, const double *aDataAbs);
   double GetA1(void);
+  int GetPowerSize(void);
+  void ComputeWindow(const int aBandIndex, double *aWindow_r, double *aWindow_i);
+  static unsigned int GetFftPlanFlag(const string aFftPlan);
  
   // Q-PLANE
   double Q;                         ///< Q value
@@ -69,10 +115,33 @@ class Oqplane: public Omap {
     
   // FREQUENCY BANDS
   int *bandWindowSize;              ///< band bisquare window size
-  double **bandWindow_r;            ///< band bisquare windows (real)
-  double **bandWindow_i;            ///< band bisquare windows (imaginary)
+  double **bandWindowAbs;           ///< band bisquare window modulus
+  bool *bandBelow;                  //!< no tile above threshold (energy bound) / band (last projection)
   double *bandNoiseAmplitude;       ///< band noise power
-  fft **bandFFT;                    ///< band ffts
+  double **bandPowerWindow;         ///< band squared window to average the noise power
+  int *bandPowerStart;              ///< first frequency bin (1/TimeRange) of the band squared window
+  double *bandPowerFrac;            ///< band squared window shift with respect to the frequency bins [bin]
+
+  // BAND BATCHES
+  int nbatches;                     ///< number of band batches
+  int *batchStart;                  ///< first band of each batch
+  int *batchSize;                   ///< number of bands in each batch
+  int *bandBatch;                   ///< batch index / band
+  double *batchSNRDeviation;        ///< maximum SNR deviation single/double precision / batch
+  int *batchTileStart;              ///< first time tile to project / batch
+  int *batchTileEnd;                ///< last time tile to project (excluded) / batch
+  bool *batchSkip;                  //!< do not project the batch (coarse search) / batch
+
+  // TILES ABOVE THRESHOLD
+  vector <Oqtile> *bandTiles;       //!< tiles above threshold / band (last projection)
+  int *bandTilesStart;              ///< first time tile index scanned for bandTiles
+  int *bandTilesEnd;                ///< last time tile index scanned for bandTiles (excluded)
+  double *bandTilesSNRThr2;         ///< SNR^2 threshold used for bandTiles
+
+  // PROJECTION
+  string precision;                 ///< projection precision: "double", "single" or "validate"
+  Oqengine<double> *engine;         //!< projection engine (double precision)
+  Oqengine<float> *enginef;         //!< projection engine (single precision)
     
   ClassDef(Oqplane,0)  
 };
@@ -0,0 +1,306 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Osimd.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define OSIMD_X86
+#endif
+
+/**
+ * @brief Complex multiplication kernel.
+ */
+typedef void (*ComplexMultiplyKernel)(const int, double*, const double*, const double*, const double*, const double*);
+
+/**
+ * @brief Scalar product kernel.
+ */
+typedef double (*DotKernel)(const int, const double*, const double*);
+
+/**
+ * @brief Complex multiplication kernel (single precision).
+ */
+typedef void (*ComplexMultiplyKernelF)(const int, float*, const float*, const float*, const float*, const float*);
+
+////////////////////////////////////////////////////////////////////////////////////
+static void ComplexMultiply_scalar(const int aN, double *aOut,
+                                   const double *aW_r, const double *aW_i,
+                                   const double *aX_r, const double *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  for(int k=0; k<aN; k++){
+    aOut[2*k]   = aW_r[k]*aX_r[k] - aW_i[k]*aX_i[k];
+    aOut[2*k+1] = aW_i[k]*aX_r[k] + aW_r[k]*aX_i[k];
+  }
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+static void ComplexMultiplyF_scalar(const int aN, float *aOut,
+                                    const float *aW_r, const float *aW_i,
+                                    const float *aX_r, const float *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  for(int k=0; k<aN; k++){
+    aOut[2*k]   = aW_r[k]*aX_r[k] - aW_i[k]*aX_i[k];
+    aOut[2*k+1] = aW_i[k]*aX_r[k] + aW_r[k]*aX_i[k];
+  }
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+static double DotSum(const double *aS, const int aN, const double *aX, const double *aY){
+////////////////////////////////////////////////////////////////////////////////////
+  // fixed summation order of the partial sums
+  double sum = ((aS[0]+aS[1])+(aS[2]+aS[3]))+((aS[4]+aS[5])+(aS[6]+aS[7]));
+
+  // left-over
+  for(int k=0; k<aN; k++) sum += aX[k]*aY[k];
+  return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+static double Dot_scalar(const int aN, const double *aX, const double *aY){
+////////////////////////////////////////////////////////////////////////////////////
+  double s[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  int k=0;
+  for(; k+8<=aN; k+=8)
+    for(int l=0; l<8; l++) s[l] += aX[k+l]*aY[k+l];
+  return DotSum(s, aN-k, aX+k, aY+k);
+}
+
+#ifdef OSIMD_X86
+
+////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx2")))
+static double Dot_avx2(const int aN, const double *aX, const double *aY){
+////////////////////////////////////////////////////////////////////////////////////
+  __m256d s0 = _mm256_setzero_pd();
+  __m256d s1 = _mm256_setzero_pd();
+  int k=0;
+  for(; k+8<=aN; k+=8){
+    s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(aX+k),   _mm256_loadu_pd(aY+k)));
+    s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(aX+k+4), _mm256_loadu_pd(aY+k+4)));
+  }
+  double s[8];
+  _mm256_storeu_pd(s,   s0);
+  _mm256_storeu_pd(s+4, s1);
+  return DotSum(s, aN-k, aX+k, aY+k);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx512f")))
+static double Dot_avx512(const int aN, const double *aX, const double *aY){
+////////////////////////////////////////////////////////////////////////////////////
+  __m512d s0 = _mm512_setzero_pd();
+  int k=0;
+  for(; k+8<=aN; k+=8)
+    s0 = _mm512_add_pd(s0, _mm512_mul_pd(_mm512_loadu_pd(aX+k), _mm512_loadu_pd(aY+k)));
+  double s[8];
+  _mm512_storeu_pd(s, s0);
+  return DotSum(s, aN-k, aX+k, aY+k);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx2")))
+static void ComplexMultiply_avx2(const int aN, double *aOut,
+                                 const double *aW_r, const double *aW_i,
+                                 const double *aX_r, const double *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  __m256d wr, wi, xr, xi, re, im, lo, hi;
+  int k=0;
+  for(; k+4<=aN; k+=4){
+    wr = _mm256_loadu_pd(aW_r+k);
+    wi = _mm256_loadu_pd(aW_i+k);
+    xr = _mm256_loadu_pd(aX_r+k);
+    xi = _mm256_loadu_pd(aX_i+k);
+    re = _mm256_sub_pd(_mm256_mul_pd(wr,xr), _mm256_mul_pd(wi,xi));
+    im = _mm256_add_pd(_mm256_mul_pd(wi,xr), _mm256_mul_pd(wr,xi));
+
+    // interleave: (r0 i0 r2 i2) (r1 i1 r3 i3) --> (r0 i0 r1 i1) (r2 i2 r3 i3)
+    lo = _mm256_unpacklo_pd(re,im);
+    hi = _mm256_unpackhi_pd(re,im);
+    _mm256_storeu_pd(aOut+2*k,   _mm256_permute2f128_pd(lo,hi,0x20));
+    _mm256_storeu_pd(aOut+2*k+4, _mm256_permute2f128_pd(lo,hi,0x31));
+  }
+
+  // left-over
+  ComplexMultiply_scalar(aN-k, aOut+2*k, aW_r+k, aW_i+k, aX_r+k, aX_i+k);
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx512f")))
+static void ComplexMultiply_avx512(const int aN, double *aOut,
+                                   const double *aW_r, const double *aW_i,
+                                   const double *aX_r, const double *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  const __m512i ilo = _mm512_set_epi64(11,3,10,2,9,1,8,0);
+  const __m512i ihi = _mm512_set_epi64(15,7,14,6,13,5,12,4);
+  __m512d wr, wi, xr, xi, re, im;
+  int k=0;
+  for(; k+8<=aN; k+=8){
+    wr = _mm512_loadu_pd(aW_r+k);
+    wi = _mm512_loadu_pd(aW_i+k);
+    xr = _mm512_loadu_pd(aX_r+k);
+    xi = _mm512_loadu_pd(aX_i+k);
+    re = _mm512_sub_pd(_mm512_mul_pd(wr,xr), _mm512_mul_pd(wi,xi));
+    im = _mm512_add_pd(_mm512_mul_pd(wi,xr), _mm512_mul_pd(wr,xi));
+
+    // interleave
+    _mm512_storeu_pd(aOut+2*k,   _mm512_permutex2var_pd(re,ilo,im));
+    _mm512_storeu_pd(aOut+2*k+8, _mm512_permutex2var_pd(re,ihi,im));
+  }
+
+  // left-over
+  ComplexMultiply_scalar(aN-k, aOut+2*k, aW_r+k, aW_i+k, aX_r+k, aX_i+k);
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx2")))
+static void ComplexMultiplyF_avx2(const int aN, float *aOut,
+                                  const float *aW_r, const float *aW_i,
+                                  const float *aX_r, const float *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  __m256 wr, wi, xr, xi, re, im, lo, hi;
+  int k=0;
+  for(; k+8<=aN; k+=8){
+    wr = _mm256_loadu_ps(aW_r+k);
+    wi = _mm256_loadu_ps(aW_i+k);
+    xr = _mm256_loadu_ps(aX_r+k);
+    xi = _mm256_loadu_ps(aX_i+k);
+    re = _mm256_sub_ps(_mm256_mul_ps(wr,xr), _mm256_mul_ps(wi,xi));
+    im = _mm256_add_ps(_mm256_mul_ps(wi,xr), _mm256_mul_ps(wr,xi));
+
+    // interleave: (r0 i0 r1 i1 r4 i4 r5 i5) (r2 i2 r3 i3 r6 i6 r7 i7) --> (r0 i0 ... r3 i3) (r4 i4 ... r7 i7)
+    lo = _mm256_unpacklo_ps(re,im);
+    hi = _mm256_unpackhi_ps(re,im);
+    _mm256_storeu_ps(aOut+2*k,   _mm256_permute2f128_ps(lo,hi,0x20));
+    _mm256_storeu_ps(aOut+2*k+8, _mm256_permute2f128_ps(lo,hi,0x31));
+  }
+
+  // left-over
+  ComplexMultiplyF_scalar(aN-k, aOut+2*k, aW_r+k, aW_i+k, aX_r+k, aX_i+k);
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx512f")))
+static void ComplexMultiplyF_avx512(const int aN, float *aOut,
+                                    const float *aW_r, const float *aW_i,
+                                    const float *aX_r, const float *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  const __m512i ilo = _mm512_set_epi32(23,7,22,6,21,5,20,4,19,3,18,2,17,1,16,0);
+  const __m512i ihi = _mm512_set_epi32(31,15,30,14,29,13,28,12,27,11,26,10,25,9,24,8);
+  __m512 wr, wi, xr, xi, re, im;
+  int k=0;
+  for(; k+16<=aN; k+=16){
+    wr = _mm512_loadu_ps(aW_r+k);
+    wi = _mm512_loadu_ps(aW_i+k);
+    xr = _mm512_loadu_ps(aX_r+k);
+    xi = _mm512_loadu_ps(aX_i+k);
+    re = _mm512_sub_ps(_mm512_mul_ps(wr,xr), _mm512_mul_ps(wi,xi));
+    im = _mm512_add_ps(_mm512_mul_ps(wi,xr), _mm512_mul_ps(wr,xi));
+
+    // interleave
+    _mm512_storeu_ps(aOut+2*k,    _mm512_permutex2var_ps(re,ilo,im));
+    _mm512_storeu_ps(aOut+2*k+16, _mm512_permutex2var_ps(re,ihi,im));
+  }
+
+  // left-over
+  ComplexMultiplyF_scalar(aN-k, aOut+2*k, aW_r+k, aW_i+k, aX_r+k, aX_i+k);
+  return;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////
+static string SimdDispatch(void){
+////////////////////////////////////////////////////////////////////////////////////
+#ifdef OSIMD_X86
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")) return "avx512f";
+  if(__builtin_cpu_supports("avx2")) return "avx2";
+#endif
+  return "scalar";
+}
+
+/**
+ * @brief Instruction set selected at run time.
+ */
+static const string simd_iset = SimdDispatch();
+
+////////////////////////////////////////////////////////////////////////////////////
+static ComplexMultiplyKernel SimdComplexMultiplyKernel(void){
+////////////////////////////////////////////////////////////////////////////////////
+#ifdef OSIMD_X86
+  if(!simd_iset.compare("avx512f")) return ComplexMultiply_avx512;
+  if(!simd_iset.compare("avx2")) return ComplexMultiply_avx2;
+#endif
+  return ComplexMultiply_scalar;
+}
+
+/**
+ * @brief Complex multiplication kernel selected at run time.
+ */
+static const ComplexMultiplyKernel simd_complexmultiply = SimdComplexMultiplyKernel();
+
+////////////////////////////////////////////////////////////////////////////////////
+static ComplexMultiplyKernelF SimdComplexMultiplyKernelF(void){
+////////////////////////////////////////////////////////////////////////////////////
+#ifdef OSIMD_X86
+  if(!simd_iset.compare("avx512f")) return ComplexMultiplyF_avx512;
+  if(!simd_iset.compare("avx2")) return ComplexMultiplyF_avx2;
+#endif
+  return ComplexMultiplyF_scalar;
+}
+
+/**
+ * @brief Complex multiplication kernel selected at run time (single precision).
+ */
+static const ComplexMultiplyKernelF simd_complexmultiplyf = SimdComplexMultiplyKernelF();
+
+////////////////////////////////////////////////////////////////////////////////////
+static DotKernel SimdDotKernel(void){
+////////////////////////////////////////////////////////////////////////////////////
+#ifdef OSIMD_X86
+  if(!simd_iset.compare("avx512f")) return Dot_avx512;
+  if(!simd_iset.compare("avx2")) return Dot_avx2;
+#endif
+  return Dot_scalar;
+}
+
+/**
+ * @brief Scalar product kernel selected at run time.
+ */
+static const DotKernel simd_dot = SimdDotKernel();
+
+////////////////////////////////////////////////////////////////////////////////////
+void SimdComplexMultiply(const int aN, double *aOut,
+                         const double *aW_r, const double *aW_i,
+                         const double *aX_r, const double *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  simd_complexmultiply(aN, aOut, aW_r, aW_i, aX_r, aX_i);
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SimdComplexMultiply(const int aN, float *aOut,
+                         const float *aW_r, const float *aW_i,
+                         const float *aX_r, const float *aX_i){
+////////////////////////////////////////////////////////////////////////////////////
+  simd_complexmultiplyf(aN, aOut, aW_r, aW_i, aX_r, aX_i);
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+double SimdDot(const int aN, const double *aX, const double *aY){
+////////////////////////////////////////////////////////////////////////////////////
+  return simd_dot(aN, aX, aY);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+string SimdGetInstructionSet(void){
+////////////////////////////////////////////////////////////////////////////////////
+  return simd_iset;
+}
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#ifndef __Osimd__
+#define __Osimd__
+
+#include <CUtils.h>
+
+using namespace std;
+
+/**
+ * @file
+ * @brief Vectorized kernels.
+ * @details The kernels are compiled for several instruction sets (scalar, AVX2, AVX-512). The best instruction set supported by the CPU is selected at run time.
+ *
+ * The kernels never use fused multiply-add operations: the results are identical whatever the instruction set.
+ */
+
+/**
+ * @brief Multiplies two complex vectors.
+ * @details The complex vectors are given as structures of arrays (real and imaginary parts). The result is written as an array of interleaved complex numbers (real, imaginary), as expected by FFTW:
+ * @verbatim
+aOut[2k]   = aW_r[k]*aX_r[k] - aW_i[k]*aX_i[k]
+aOut[2k+1] = aW_i[k]*aX_r[k] + aW_r[k]*aX_i[k]
+@endverbatim
+ * @param[in] aN Number of complex numbers.
+ * @param[out] aOut Output array of 2*aN interleaved values.
+ * @param[in] aW_r First vector: real part.
+ * @param[in] aW_i First vector: imaginary part.
+ * @param[in] aX_r Second vector: real part.
+ * @param[in] aX_i Second vector: imaginary part.
+ */
+void SimdComplexMultiply(const int aN, double *aOut,
+                         const double *aW_r, const double *aW_i,
+                         const double *aX_r, const double *aX_i);
+
+/**
+ * @brief Multiplies two complex vectors (single precision).
+ * @details Same as SimdComplexMultiply() for single-precision numbers.
+ * @param[in] aN Number of complex numbers.
+ * @param[out] aOut Output array of 2*aN interleaved values.
+ * @param[in] aW_r First vector: real part.
+ * @param[in] aW_i First vector: imaginary part.
+ * @param[in] aX_r Second vector: real part.
+ * @param[in] aX_i Second vector: imaginary part.
+ */
+void SimdComplexMultiply(const int aN, float *aOut,
+                         const float *aW_r, const float *aW_i,
+                         const float *aX_r, const float *aX_i);
+
+/**
+ * @brief Scalar product of two vectors.
+ * @details The products are summed in 8 partial sums, which are added in a fixed order:
+ * @verbatim
+return sum_k aX[k]*aY[k]
+@endverbatim
+ * @param[in] aN Number of elements.
+ * @param[in] aX First vector.
+ * @param[in] aY Second vector.
+ */
+double SimdDot(const int aN, const double *aX, const double *aY);
+
+/**
+ * @brief Returns the name of the instruction set used by the kernels.
+ * @details "avx512f", "avx2" or "scalar".
+ */
+string SimdGetInstructionSet(void);
+
+#endif
+
+
@@ -2,6 +2,23 @@
 //  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
 //////////////////////////////////////////////////////////////////////////////
 #include "Otile.h"
+#include "Opool.h"
+#include <cstring>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Tiling cache file signature and format version.
+ */
+static const char otile_cache_magic[8] = "OTILE01";
+
+/**
+ * @brief Otile counter, to give a unique name to the plot canvas.
+ */
+static atomic<int> otile_ctr(0);
 
 ClassImp(Otile)
 
@@ -10,7 +27,9 @@ Otile::Otile(const int aTimeRange,
 	     const double aQMin, const double aQMax, 
 	     const double aFrequencyMin, const double aFrequencyMax, 
 	     const int aSampleFrequency, const double aMaximumMismatch, 
-	     const string aPlotStyle, const int aVerbosity): GwollumPlot("otile",aPlotStyle){
+	     const string aPlotStyle, const int aVerbosity, const string aFftPlan,
+	     const string aPrecision, const string aTilingCache,
+	     const bool aSparseProjection): GwollumPlot("otile"+to_string(otile_ctr++),aPlotStyle){
 ////////////////////////////////////////////////////////////////////////////////////
  
   // Plot default
@@ -18,12 +37,14 @@ Otile::Otile(const int aTimeRange,
 
   // save parameters
   TimeRange=(int)fabs(aTimeRange);
-  double QMin=fabs(aQMin);
-  double QMax=fabs(aQMax);
-  double FrequencyMin=fabs(aFrequencyMin);
-  double FrequencyMax=fabs(aFrequencyMax);
-  int SampleFrequency=(int)fabs(aSampleFrequency);
+  QMin=fabs(aQMin);
+  QMax=fabs(aQMax);
+  FrequencyMin=fabs(aFrequencyMin);
+  FrequencyMax=fabs(aFrequencyMax);
+  SampleFrequency=(int)fabs(aSampleFrequency);
   MaximumMismatch=TMath::Max(0.01,fabs(aMaximumMismatch));
+  FftPlan=aFftPlan;
+  SparseProjection=aSparseProjection;
   fVerbosity=aVerbosity;
   
   ////// Adjust parameters   ////////////////////////////////
@@ -47,17 +68,109 @@ Otile::Otile(const int aTimeRange,
   vector <double> Qs = ComputeQs(QMin,QMax,MaximumMismatch);
   nq = (int)Qs.size();
  
+  // tiling cache
+  OtileCacheHeader cacheheader;
+  memset(&cacheheader, 0, sizeof(OtileCacheHeader));
+  memcpy(cacheheader.magic, otile_cache_magic, sizeof(cacheheader.magic));
+  cacheheader.timerange=TimeRange;
+  cacheheader.samplefrequency=SampleFrequency;
+  cacheheader.qmin=QMin;
+  cacheheader.qmax=QMax;
+  cacheheader.frequencymin=FrequencyMin;
+  cacheheader.frequencymax=FrequencyMax;
+  cacheheader.mismatch=MaximumMismatch;
+  cacheheader.nq=nq;
+  string cachefile="";
+  void *cachemap=NULL;
+  size_t cachemapsize=0;
+  const long int *cacheoffset=NULL;
+  const double *cachewindows=NULL;
+  if(aTilingCache.compare("none")){
+    ostringstream cachestream;
+    cachestream<<aTilingCache<<"/otile_"<<TimeRange<<"_"<<SampleFrequency<<"_"<<setprecision(4)<<fixed<<QMin<<"-"<<QMax<<"_"<<FrequencyMin<<"-"<<FrequencyMax<<"_"<<MaximumMismatch<<".bin";
+    cachefile=cachestream.str();
+    cachemap=MapTilingCache(cachefile, cacheheader, cachemapsize);
+    if(cachemap!=NULL){
+      cacheoffset=(const long int*)((const char*)cachemap+sizeof(OtileCacheHeader));
+      cachewindows=(const double*)(cacheoffset+nq+1);
+      if(aVerbosity) cout<<"Otile::Otile: the tiling is loaded from "<<cachefile<<endl;
+    }
+  }
+
   // create Q planes
-  if(aVerbosity) cout<<"Otile::Otile: creating "<<nq<<" Q-planes"<<endl;
+  if(aVerbosity) cout<<"Otile::Otile: creating "<<nq<<" Q-planes (vector instructions: "<<SimdGetInstructionSet()<<")"<<endl;
   qplanes = new Oqplane* [nq];
   t_snrmax=new int* [nq];
   f_snrmax=new int* [nq];
   for(int q=0; q<nq; q++){
-    qplanes[q]=new Oqplane(Qs[q],SampleFrequency,TimeRange,FrequencyMin,FrequencyMax,MismatchStep);
+    if(cachemap!=NULL)
+      qplanes[q]=new Oqplane(Qs[q],SampleFrequency,TimeRange,FrequencyMin,FrequencyMax,MismatchStep,aFftPlan,aPrecision,SparseProjection,cachewindows+cacheoffset[q],cacheoffset[q+1]-cacheoffset[q]);
+    else
+      qplanes[q]=new Oqplane(Qs[q],SampleFrequency,TimeRange,FrequencyMin,FrequencyMax,MismatchStep,aFftPlan,aPrecision,SparseProjection);
     if(aVerbosity>1) qplanes[q]->PrintParameters();
   }
   Qs.clear();
 
+  // the windows are copied in the Q-planes: release or create the cache
+  if(cachemap!=NULL) munmap(cachemap, cachemapsize);
+  else if(aTilingCache.compare("none")){
+    if(SaveTilingCache(cachefile, cacheheader)&&aVerbosity) cout<<"Otile::Otile: the tiling is saved in "<<cachefile<<endl;
+  }
+
+  // projection work items: all band batches, largest first
+  for(int q=0; q<nq; q++){
+    for(int b=qplanes[q]->GetNBatches()-1; b>=0; b--){
+      work_q.push_back(q);
+      work_b.push_back(b);
+    }
+  }
+  vector <int> work_i(work_q.size());
+  for(int i=0; i<(int)work_i.size(); i++) work_i[i]=i;
+  stable_sort(work_i.begin(), work_i.end(), [this](const int i1, const int i2){
+      return qplanes[work_q[i1]]->GetBatchCost(work_b[i1])>qplanes[work_q[i2]]->GetBatchCost(work_b[i2]);
+    });
+  vector <int> work_tmp(work_q);
+  for(int i=0; i<(int)work_i.size(); i++) work_q[i]=work_tmp[work_i[i]];
+  work_tmp=work_b;
+  for(int i=0; i<(int)work_i.size(); i++) work_b[i]=work_tmp[work_i[i]];
+  work_nt = new int [work_q.size()];
+  pool=NULL;
+
+  // band power: noise powers sampled on the frequency bins
+  PowerSize=0;
+  for(int q=0; q<nq; q++) PowerSize=TMath::Max(PowerSize, qplanes[q]->GetPowerSize());
+  PowerMin=PowerSize;
+  for(int q=0; q<nq; q++)
+    for(int f=0; f<qplanes[q]->GetNBands(); f++) PowerMin=TMath::Min(PowerMin, qplanes[q]->bandPowerStart[f]);
+  PowerVect1 = new double [PowerSize];
+  PowerVect2 = new double [PowerSize];
+  PowerWork  = new double [PowerSize];
+  PowerDrift = new int [PowerSize+1];
+  for(int i=0; i<PowerSize; i++){ PowerVect1[i]=0.0; PowerVect2[i]=0.0; PowerDrift[i]=0; }
+  PowerDrift[PowerSize]=0;
+  PowerInit=false;
+  PowerTolerance=0.0;
+
+  // no coarse search
+  CoarseMismatch=0.0;
+  ncq=0;
+  cqplanes=NULL;
+  coarseskip=0.0;
+
+  // data spectrum (allocated when projecting data)
+  spec_n=0;
+  spec_r=NULL;
+  spec_i=NULL;
+  spec_rf=NULL;
+  spec_if=NULL;
+  spec_a=NULL;
+  snrdev=0.0;
+  energybound=false;
+
+  // projection precision
+  precision=qplanes[0]->precision;
+  if(aVerbosity) cout<<"Otile::Otile: projection precision = "<<precision<<endl;
+
   // update parameters  
   TimeRange=qplanes[0]->GetTimeRange();
 
@@ -79,6 +192,7 @@ Otile::Otile(const int aTimeRange,
   SeqOutSegments = new Segments();
   SeqOverlap=0;
   SeqOverlapCurrent=SeqOverlap;
+  SeqStride=0;
   SeqT0=0;
   SeqSeg=0;
 }
@@ -91,6 +205,19 @@ Otile::~Otile(void){
     delete qplanes[q];
   }
   delete qplanes;
+  for(int q=0; q<ncq; q++) delete cqplanes[q];
+  delete [] cqplanes;
+  if(pool!=NULL) delete pool;
+  delete [] work_nt;
+  delete [] spec_r;
+  delete [] spec_i;
+  delete [] spec_rf;
+  delete [] spec_if;
+  delete [] spec_a;
+  delete [] PowerVect1;
+  delete [] PowerVect2;
+  delete [] PowerWork;
+  delete [] PowerDrift;
   delete t_snrmax;
   delete f_snrmax;
   delete SeqInSegments;
@@ -99,6 +226,86 @@ Otile::~Otile(void){
 }
  
 
+////////////////////////////////////////////////////////////////////////////////////
+void* Otile::MapTilingCache(const string aFileName, const OtileCacheHeader &aHeader, size_t &aMapSize){
+////////////////////////////////////////////////////////////////////////////////////
+  aMapSize=0;
+
+  // no cache file yet
+  int fd = open(aFileName.c_str(), O_RDONLY);
+  if(fd<0) return NULL;
+
+  struct stat st;
+  if(fstat(fd, &st)||(size_t)st.st_size<sizeof(OtileCacheHeader)+(aHeader.nq+1)*sizeof(long int)){
+    cerr<<"Otile::MapTilingCache: the tiling cache file "<<aFileName<<" is corrupted"<<endl;
+    close(fd);
+    return NULL;
+  }
+
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map==MAP_FAILED){
+    cerr<<"Otile::MapTilingCache: cannot map the tiling cache file "<<aFileName<<endl;
+    return NULL;
+  }
+
+  // check parameters, window offsets and size
+  // the offsets locate the Q-plane windows: they must start at 0, be monotonic and end with the file
+  const long int *offset=(const long int*)((const char*)map+sizeof(OtileCacheHeader));
+  size_t nwindows=((size_t)st.st_size-sizeof(OtileCacheHeader)-(aHeader.nq+1)*sizeof(long int))/sizeof(double);
+  bool match=!memcmp(map, &aHeader, sizeof(OtileCacheHeader))&&offset[0]==0;
+  for(int q=0; match&&q<aHeader.nq; q++) match=offset[q+1]>=offset[q];
+  if(!match||
+     (size_t)offset[aHeader.nq]!=nwindows||
+     (size_t)st.st_size!=sizeof(OtileCacheHeader)+(aHeader.nq+1)*sizeof(long int)+nwindows*sizeof(double)){
+    cerr<<"Otile::MapTilingCache: the tiling cache file "<<aFileName<<" does not match the tiling --> compute the tiling"<<endl;
+    munmap(map, st.st_size);
+    return NULL;
+  }
+
+  aMapSize=st.st_size;
+  return map;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Otile::SaveTilingCache(const string aFileName, const OtileCacheHeader &aHeader){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // window offsets
+  long int *offset = new long int [nq+1];
+  offset[0]=0;
+  for(int q=0; q<nq; q++) offset[q+1]=offset[q]+qplanes[q]->GetWindowsSize();
+
+  // write in a temporary file and move it: other jobs never map a partial file
+  ostringstream tmpname;
+  tmpname<<aFileName<<".tmp."<<getpid();
+  ofstream cachefile(tmpname.str().c_str(), ios::binary);
+  if(!cachefile.is_open()){
+    cerr<<"Otile::SaveTilingCache: cannot write the tiling cache file "<<aFileName<<endl;
+    delete [] offset;
+    return false;
+  }
+  cachefile.write((const char*)&aHeader, sizeof(OtileCacheHeader));
+  cachefile.write((const char*)offset, (nq+1)*sizeof(long int));
+  double *windows;
+  for(int q=0; q<nq; q++){
+    windows = new double [offset[q+1]-offset[q]];
+    qplanes[q]->GetWindows(windows);
+    cachefile.write((const char*)windows, (offset[q+1]-offset[q])*sizeof(double));
+    delete [] windows;
+  }
+  delete [] offset;
+  cachefile.close();
+
+  if(cachefile.fail()||rename(tmpname.str().c_str(), aFileName.c_str())){
+    cerr<<"Otile::SaveTilingCache: cannot write the tiling cache file "<<aFileName<<endl;
+    remove(tmpname.str().c_str());
+    return false;
+  }
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 bool Otile::SetSegments(Segments *aInSeg, Segments *aOutSeg){
 ////////////////////////////////////////////////////////////////////////////////////
@@ -124,46 +331,92 @@ bool Otile::SetSegments(Segments *aInSeg, Segments *aOutSeg){
 ////////////////////////////////////////////////////////////////////////////////////
 bool Otile::NewChunk(bool &aNewSegFlag){
 ////////////////////////////////////////////////////////////////////////////////////
-  if(SeqSeg>=SeqInSegments->GetNsegments()){
+  if(!NextChunk(SeqSeg, SeqT0, SeqOverlapCurrent, aNewSegFlag)){
     cerr<<"Otile::NewChunk: end of segments"<<endl;
     return false;
   }
+
+  // streaming: only project the chunk output
+  if(SeqStride) SetProjectionWindow((double)GetChunkOutputStart(), (double)GetChunkOutputEnd());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Otile::GetNextChunks(const int aN, vector <int> &aStarts, vector <int> &aEnds){
+////////////////////////////////////////////////////////////////////////////////////
+  aStarts.clear(); aEnds.clear();
+  int seg=SeqSeg, t0=SeqT0, overlap=SeqOverlapCurrent;
+  bool newseg;
+  for(int n=0; n<aN; n++){
+    if(!NextChunk(seg, t0, overlap, newseg)) break;
+    aStarts.push_back(t0-TimeRange/2);
+    aEnds.push_back(t0+TimeRange/2);
+  }
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Otile::NextChunk(int &aSeg, int &aT0, int &aOverlapCurrent, bool &aNewSegFlag){
+////////////////////////////////////////////////////////////////////////////////////
+  if(aSeg>=SeqInSegments->GetNsegments()) return false;
   
   // current segment is too short
-  if((int)SeqInSegments->GetEnd(SeqSeg)-(int)SeqInSegments->GetStart(SeqSeg)<TimeRange){
-    SeqSeg++; //  --> move to next segment
-    SeqT0=0;
-    return NewChunk(aNewSegFlag);
+  if((int)SeqInSegments->GetEnd(aSeg)-(int)SeqInSegments->GetStart(aSeg)<TimeRange){
+    aSeg++; //  --> move to next segment
+    aT0=0;
+    return NextChunk(aSeg, aT0, aOverlapCurrent, aNewSegFlag);
   }
 
   // end of current segment
-  if(SeqT0+TimeRange/2==(int)SeqInSegments->GetEnd(SeqSeg)){
-    SeqSeg++; //  --> move to next segment
-    SeqT0=0;
-    return NewChunk(aNewSegFlag);
+  if(aT0+TimeRange/2==(int)SeqInSegments->GetEnd(aSeg)){
+    aSeg++; //  --> move to next segment
+    aT0=0;
+    return NextChunk(aSeg, aT0, aOverlapCurrent, aNewSegFlag);
   }
 
   // initialization = start of current segment
-  if(!SeqT0){
-    SeqT0=(int)SeqInSegments->GetStart(SeqSeg)-TimeRange/2+SeqOverlap;
+  if(!aT0){
+    aT0=(int)SeqInSegments->GetStart(aSeg)-TimeRange/2+SeqOverlap;
     aNewSegFlag=true;
   }
   else aNewSegFlag=false;
 
   // new test chunk
-  SeqOverlapCurrent = SeqOverlap;// reset current overlap
-  int start_test    = SeqT0+TimeRange/2-SeqOverlap;
-  int stop_test     = start_test+TimeRange;
+  aOverlapCurrent = SeqOverlap;// reset current overlap
+  int start_test  = aT0+TimeRange/2-SeqOverlap;
+  int stop_test   = start_test+TimeRange;
 
   // chunk ends after current segment end --> adjust overlap
-  if(stop_test>(int)SeqInSegments->GetEnd(SeqSeg)){
-    SeqT0=(int)SeqInSegments->GetEnd(SeqSeg)-TimeRange/2;
-    SeqOverlapCurrent=start_test+SeqOverlap-SeqT0+TimeRange/2;// --> adjust overlap
-    return true;
+  if(stop_test>(int)SeqInSegments->GetEnd(aSeg)){
+    aT0=(int)SeqInSegments->GetEnd(aSeg)-TimeRange/2;
+    aOverlapCurrent=start_test+SeqOverlap-aT0+TimeRange/2;// --> adjust overlap
   }
 
   // OK  
-  SeqT0=start_test+TimeRange/2;
+  else aT0=start_test+TimeRange/2;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Otile::SetStride(const int aStride){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // standard sequence
+  if(aStride<=0){
+    if(SeqStride) SetProjectionWindow(-(double)TimeRange/2.0, (double)TimeRange/2.0);
+    SeqStride=0;
+    return true;
+  }
+
+  if(aStride%2||aStride>=TimeRange){
+    cerr<<"Otile::SetStride: the stride must be an even number smaller than the time range ("<<TimeRange<<"s)"<<endl;
+    return false;
+  }
+
+  SeqStride=aStride;
+  SetOverlapDuration(TimeRange-SeqStride);
+  if(fVerbosity) cout<<"Otile::SetStride: streaming mode with a "<<SeqStride<<"s stride (overlap = "<<SeqOverlap<<"s)"<<endl;
   return true;
 }
 
@@ -174,12 +427,26 @@ bool Otile::SetPower(Spectrum *aSpec1, Spectrum *aSpec2){
     cerr<<"Otile::SetPower: the Spectrum object is corrupted"<<endl;
     return false;
   }
-  for(int p=0; p<nq; p++){
-    if(!qplanes[p]->SetPower(aSpec1, aSpec2)){
-      cerr<<"Otile::SetPower: cannot set power for plane #"<<p<<endl;
-      return false;
+
+  // sample the noise powers on the frequency bins
+  // only the bins where the inverse noise amplitude changed beyond the tolerance are updated (cumulative count)
+  double freq, p1, p2;
+  for(int i=PowerMin; i<PowerSize; i++){
+    freq=(double)i/(double)TimeRange;
+    p1=aSpec1->GetPower(freq);
+    p2=aSpec2->GetPower(freq);
+    PowerDrift[i+1]=PowerDrift[i];
+    if(!PowerInit||!(fabs(sqrt(PowerVect1[i]*PowerVect2[i]/(p1*p2))-1.0)<=PowerTolerance)){
+      PowerVect1[i]=p1;
+      PowerVect2[i]=p2;
+      PowerDrift[i+1]++;
     }
   }
+
+  // update the bands where the power changed
+  for(int p=0; p<nq; p++) qplanes[p]->SetPower(PowerVect1, PowerVect2, PowerWork, PowerInit?PowerDrift:NULL);
+  PowerInit=true;
+
   return true;
 }
 
@@ -188,15 +455,235 @@ int Otile::ProjectData(fft *aDataFft){
 ////////////////////////////////////////////////////////////////////////////////////
 
   int nt=0;// number of tiles above threshold
+
+  // copy the data spectrum in contiguous arrays
+  // (single precision: converted)
+  if(aDataFft->GetSize_f()!=spec_n){
+    delete [] spec_r;
+    delete [] spec_i;
+    delete [] spec_rf;
+    delete [] spec_if;
+    delete [] spec_a;
+    spec_n=aDataFft->GetSize_f();
+    spec_r = new double [spec_n];
+    spec_i = new double [spec_n];
+    spec_a = new double [spec_n];
+    if(precision.compare("double")){
+      spec_rf = new float [spec_n];
+      spec_if = new float [spec_n];
+    }
+    else{
+      spec_rf = NULL;
+      spec_if = NULL;
+    }
+  }
+  for(int i=0; i<spec_n; i++){
+    spec_r[i]=aDataFft->GetRe_f(i);
+    spec_i[i]=aDataFft->GetIm_f(i);
+  }
+  if(spec_rf!=NULL){
+    for(int i=0; i<spec_n; i++){
+      spec_rf[i]=(float)spec_r[i];
+      spec_if[i]=(float)spec_i[i];
+    }
+  }
+
+  // modulus to bound the tile energy
+  const double *abs_spec=NULL;
+  if(energybound){
+    for(int i=0; i<spec_n; i++) spec_a[i]=sqrt(spec_r[i]*spec_r[i]+spec_i[i]*spec_i[i]);
+    abs_spec=spec_a;
+  }
   
+  // coarse search: select the band batches to project
+  if(ncq) CoarseSearch(abs_spec);
+
   // project onto q planes
-  for(int p=0; p<nq; p++){
-    nt+=qplanes[p]->ProjectData(aDataFft,(double)(SeqOverlap/2));
+  if(pool==NULL){
+    for(int p=0; p<nq; p++){
+      nt+=qplanes[p]->ProjectData(spec_r,spec_i,spec_rf,spec_if,abs_spec,(double)(SeqOverlap/2));
+    }
+  }
+
+  // project bands in parallel
+  else{
+    double padding=(double)(SeqOverlap/2);
+    pool->Run((int)work_q.size(), [&](const int aItem, const int aThread){
+        work_nt[aItem]=qplanes[work_q[aItem]]->ProjectBatch(work_b[aItem], spec_r, spec_i, spec_rf, spec_if, abs_spec, padding);
+      });
+    for(int i=0; i<(int)work_q.size(); i++) nt+=work_nt[i];
+  }
+
+  // validation: single vs double precision
+  if(!precision.compare("validate")){
+    snrdev=0.0;
+    for(int p=0; p<nq; p++) snrdev=TMath::Max(snrdev,qplanes[p]->GetSNRDeviation());
+    cout<<"Otile::ProjectData: single-precision validation: maximum SNR deviation = "<<snrdev<<endl;
   }
 
   return nt;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+double Otile::GetSNRMax(const double aTimeStart, const double aTimeEnd, double &aTime, double &aFrequency){
+////////////////////////////////////////////////////////////////////////////////////
+  double snr2, snr2max=0.0;
+  int tstart, tend;
+  aTime=0.0;
+  aFrequency=0.0;
+
+  for(int q=0; q<nq; q++){
+    for(int f=0; f<qplanes[q]->GetNBands(); f++){
+      tstart=TMath::Max(0,qplanes[q]->GetTimeTileIndex(f, aTimeStart));
+      tend=TMath::Min(qplanes[q]->GetBandNtiles(f)-1,qplanes[q]->GetTimeTileIndex(f, aTimeEnd));
+      for(int t=tstart; t<=tend; t++){
+        snr2=qplanes[q]->GetTileSNR2(t,f);
+        if(snr2<=snr2max) continue;
+        snr2max=snr2;
+        aTime=qplanes[q]->GetTileTime(t,f);
+        aFrequency=qplanes[q]->GetBandFrequency(f);
+      }
+    }
+  }
+
+  return sqrt(snr2max);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Otile::SetCoarseSearch(const double aCoarseMismatch){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // remove the current coarse tiling
+  for(int q=0; q<ncq; q++) delete cqplanes[q];
+  delete [] cqplanes;
+  cqplanes=NULL;
+  ncq=0;
+  CoarseMismatch=0.0;
+  coarseskip=0.0;
+  for(int q=0; q<nq; q++)
+    for(int b=0; b<qplanes[q]->GetNBatches(); b++) qplanes[q]->batchSkip[b]=false;
+
+  // no coarse search
+  if(aCoarseMismatch<=0.0) return true;
+
+  if(aCoarseMismatch<=MaximumMismatch){
+    cerr<<"Otile::SetCoarseSearch: the coarse mismatch must be larger than the maximum mismatch ("<<MaximumMismatch<<")"<<endl;
+    return false;
+  }
+  CoarseMismatch=aCoarseMismatch;
+  if(CoarseMismatch>0.8){
+    CoarseMismatch=0.8;
+    cerr<<"Otile::SetCoarseSearch: coarse mismatch is not reasonable --> set to 0.8"<<endl;
+  }
+
+  // coarse Q planes (same time and frequency ranges)
+  vector <double> Qs = ComputeQs(QMin,QMax,CoarseMismatch);
+  ncq = (int)Qs.size();
+  cqplanes = new Oqplane* [ncq];
+  long int ntiles=0, cntiles=0;
+  for(int q=0; q<ncq; q++){
+    cqplanes[q]=new Oqplane(Qs[q],SampleFrequency,TimeRange,FrequencyMin,FrequencyMax,2.0*sqrt(CoarseMismatch/3.0),FftPlan,precision.compare("double")?"single":"double",SparseProjection);
+    cntiles+=cqplanes[q]->GetNTiles();
+  }
+  for(int q=0; q<nq; q++) ntiles+=qplanes[q]->GetNTiles();
+  
+  if(fVerbosity) cout<<"Otile::SetCoarseSearch: coarse search with "<<ncq<<" Q-planes ("<<(double)cntiles/(double)ntiles*100.0<<"% of the tiles)"<<endl;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Otile::CoarseSearch(const double *aDataAbs){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // coarse SNR threshold: a tile above the SNR threshold has an energy E=SNR^2+2 above SNRThr^2+2
+  // it loses at most a fraction CoarseMismatch of this energy in the coarse tiling
+  // the threshold is lowered by COARSE_NSIGMA standard deviations of the energy in Gaussian noise: 2*sqrt(E-1)
+  double ethr=(1.0-CoarseMismatch)*(qplanes[0]->GetSNRThr()*qplanes[0]->GetSNRThr()+2.0);
+  ethr-=COARSE_NSIGMA*2.0*sqrt(TMath::Max(ethr-1.0,0.0));
+  double snrthr=sqrt(TMath::Max(ethr-2.0,0.0));
+  for(int c=0; c<ncq; c++) cqplanes[c]->SetSNRThr(snrthr);
+
+  // project onto the coarse Q planes
+  if(pool==NULL){
+    for(int c=0; c<ncq; c++) cqplanes[c]->ProjectData(spec_r,spec_i,spec_rf,spec_if,aDataAbs,(double)(SeqOverlap/2));
+  }
+  else{
+    double padding=(double)(SeqOverlap/2);
+    pool->Run(ncq, [&](const int aItem, const int aThread){
+        cqplanes[aItem]->ProjectData(spec_r,spec_i,spec_rf,spec_if,aDataAbs,padding);
+      });
+  }
+
+  // skip all fine batches
+  for(int q=0; q<nq; q++)
+    for(int b=0; b<qplanes[q]->GetNBatches(); b++) qplanes[q]->batchSkip[b]=true;
+
+  // select the fine batches around the coarse tiles above threshold
+  double fmin, fmax;
+  int fstart, fend;
+  for(int c=0; c<ncq; c++){
+    for(int f=0; f<cqplanes[c]->GetNBands(); f++){
+      if(!cqplanes[c]->bandTiles[f].size()) continue;
+
+      // frequency range: coarse band and its neighbours
+      fmin=cqplanes[c]->GetBandStart(TMath::Max(f-1,0));
+      fmax=cqplanes[c]->GetBandEnd(TMath::Min(f+1,cqplanes[c]->GetNBands()-1));
+
+      for(int q=0; q<nq; q++){
+
+        // Q range: between the neighbouring coarse Q planes
+        if(c>0&&qplanes[q]->GetQ()<cqplanes[c-1]->GetQ()) continue;
+        if(c<ncq-1&&qplanes[q]->GetQ()>cqplanes[c+1]->GetQ()) continue;
+
+        for(int b=0; b<qplanes[q]->GetNBatches(); b++){
+          if(!qplanes[q]->batchSkip[b]) continue;
+          fstart=qplanes[q]->batchStart[b];
+          fend=fstart+qplanes[q]->batchSize[b]-1;
+          if(qplanes[q]->GetBandEnd(fend)<fmin) continue;
+          if(qplanes[q]->GetBandStart(fstart)>fmax) continue;
+          qplanes[q]->batchSkip[b]=false;
+        }
+      }
+    }
+  }
+
+  // fraction of skipped tiles
+  long int ntiles=0, nskip=0;
+  for(int q=0; q<nq; q++){
+    for(int b=0; b<qplanes[q]->GetNBatches(); b++){
+      ntiles+=qplanes[q]->GetBatchCost(b);
+      if(qplanes[q]->batchSkip[b]) nskip+=qplanes[q]->GetBatchCost(b);
+    }
+  }
+  coarseskip=(double)nskip/(double)ntiles;
+  if(fVerbosity>1) cout<<"Otile::CoarseSearch: "<<coarseskip*100.0<<"% of the tiles are skipped"<<endl;
+
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void Otile::SetNThreads(const int aNthreads){
+////////////////////////////////////////////////////////////////////////////////////
+  int nthreads=aNthreads;
+  if(nthreads<=0) nthreads=(int)thread::hardware_concurrency();
+  if(nthreads<=0) nthreads=1;
+
+  if(pool!=NULL) delete pool;
+  pool=NULL;
+  if(nthreads==1) return;
+
+  if(fVerbosity) cout<<"Otile::SetNThreads: projecting data with "<<nthreads<<" threads"<<endl;
+  pool = new Opool(nthreads);
+  return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+int Otile::GetNThreads(void){
+////////////////////////////////////////////////////////////////////////////////////
+  if(pool==NULL) return 1;
+  return pool->GetNThreads();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 bool Otile::SaveTriggers(TriggerBuffer *aTriggers){
 ////////////////////////////////////////////////////////////////////////////////////
@@ -348,13 +835,14 @@ double Otile::SaveMaps(const string aOutdir, const string aName, const string aF
     
     // draw map
     if(fVerbosity>2) cout<<"\t\t- Draw map"<<endl;
-    ApplyOffset(qplanes[q],(double)SeqT0);
-    qplanes[q]->GetXaxis()->SetRange((double)SeqT0+aTimeOffset-(double)aWindows[(int)aWindows.size()-1]/2.0,(double)SeqT0+aTimeOffset+(double)aWindows[(int)aWindows.size()-1]/2.0);
-    Draw(qplanes[q],"COLZ");
+    qplanes[q]->GetMap()->GetZaxis()->SetTitle(StringToUpper(mapfill).c_str());
+    ApplyOffset(qplanes[q]->GetMap(),(double)SeqT0);
+    qplanes[q]->GetMap()->GetXaxis()->SetRange((double)SeqT0+aTimeOffset-(double)aWindows[(int)aWindows.size()-1]/2.0,(double)SeqT0+aTimeOffset+(double)aWindows[(int)aWindows.size()-1]/2.0);
+    Draw(qplanes[q]->GetMap(),"COLZ");
     
     // title
     tmpstream<<aName<<": Q="<<fixed<<setprecision(3)<<qplanes[q]->GetQ();
-    qplanes[q]->SetTitle(tmpstream.str().c_str());
+    qplanes[q]->GetMap()->SetTitle(tmpstream.str().c_str());
     tmpstream.clear(); tmpstream.str("");
     
     // loop over time windows
@@ -362,7 +850,7 @@ double Otile::SaveMaps(const string aOutdir, const string aName, const string aF
     for(int w=0; w<(int)aWindows.size(); w++){
       
       // zoom in
-      qplanes[q]->GetXaxis()->SetRangeUser((double)SeqT0+aTimeOffset-(double)aWindows[w]/2.0,(double)SeqT0+aTimeOffset+(double)aWindows[w]/2.0);
+      qplanes[q]->GetMap()->GetXaxis()->SetRangeUser((double)SeqT0+aTimeOffset-(double)aWindows[w]/2.0,(double)SeqT0+aTimeOffset+(double)aWindows[w]/2.0);
       
       // loudest tile
       if(!mapfill.compare("amplitude")) tmpstream<<"Loudest: GPS="<<fixed<<setprecision(3)<<qplanes[q]->GetTileTime(t_snrmax[q][w],f_snrmax[q][w])<<", f="<<qplanes[q]->GetBandFrequency(f_snrmax[q][w])<<" Hz, "<<mapfill<<"="<<scientific<<qplanes[q]->GetTileContent(t_snrmax[q][w],f_snrmax[q][w]);
@@ -371,8 +859,8 @@ double Otile::SaveMaps(const string aOutdir, const string aName, const string aF
       tmpstream.clear(); tmpstream.str("");
       
       // set vertical range
-      if(vrange[0]<vrange[1]) qplanes[q]->GetZaxis()->SetRangeUser(vrange[0],vrange[1]);
-      else qplanes[q]->GetZaxis()->UnZoom();
+      if(vrange[0]<vrange[1]) qplanes[q]->GetMap()->GetZaxis()->SetRangeUser(vrange[0],vrange[1]);
+      else qplanes[q]->GetMap()->GetZaxis()->UnZoom();
       
       // save plot
       for(int f=0; f<(int)form.size(); f++){
@@ -410,8 +898,8 @@ double Otile::SaveMaps(const string aOutdir, const string aName, const string aF
     }
     
     // unzoom
-    qplanes[q]->GetXaxis()->UnZoom();
-    ApplyOffset(qplanes[q],-(double)SeqT0);
+    qplanes[q]->GetMap()->GetXaxis()->UnZoom();
+    ApplyOffset(qplanes[q]->GetMap(),-(double)SeqT0);
   }
   
   // full map
@@ -492,14 +980,14 @@ bool Otile::DrawMapTiling(const int aQindex){
     return false;
   }
   qplanes[aQindex]->FillMap("display",-TimeRange/2,TimeRange/2);
-  qplanes[aQindex]->GetZaxis()->SetRangeUser(0,100);
+  qplanes[aQindex]->GetMap()->GetZaxis()->SetRangeUser(0,100);
   SetLogx(0);
   SetLogy(1);
   SetGridx(0);
   SetGridy(0);
-  Draw(qplanes[aQindex],"COL");
+  Draw(qplanes[aQindex]->GetMap(),"COL");
   /*
-  qplanes[aQindex]->GetXaxis()->SetRangeUser(-0.1,0.1);
+  qplanes[aQindex]->GetMap()->GetXaxis()->SetRangeUser(-0.1,0.1);
   TLine *lf;
   for(int f=0; f<qplanes[aQindex]->GetNBands(); f++){
     lf = new TLine(-0.1,qplanes[aQindex]->GetBandStart(f),0.1,qplanes[aQindex]->GetBandStart(f));
@@ -543,6 +1031,7 @@ TH2D* Otile::MakeFullMap(const int aTimeRange, const double aTimeOffset){
   int ntbins = 301;
 
   TH2D *fullmap = new TH2D("fullmap","Full map",ntbins,SeqT0+aTimeOffset-(double)aTimeRange/2.0,SeqT0+aTimeOffset+(double)aTimeRange/2.0,nfbins,fbins);
+  fullmap->SetDirectory(0);// owned by the caller
   delete fbins;
   fullmap->GetXaxis()->SetTitle("Time [s]");
   fullmap->GetYaxis()->SetTitle("Frequency [Hz]");
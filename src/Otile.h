@@ -9,6 +9,27 @@
 
 using namespace std;
 
+// coarse search: noise margin of the coarse energy threshold [sigma]
+#define COARSE_NSIGMA 1.0
+
+class Opool;
+
+/**
+ * Tiling cache file header.
+ * A tiling cache file starts with this header. It identifies the tiling parameters. It is followed by the window offsets of the Q-planes (`nq+1` `long int` values) and by the band windows of all Q-planes (`double` values).
+ */
+struct OtileCacheHeader {
+  char magic[8];                    ///< file signature and format version
+  int timerange;                    ///< time range [s]
+  int samplefrequency;              ///< sampling frequency [Hz]
+  double qmin;                      ///< minimal Q value
+  double qmax;                      ///< maximal Q value
+  double frequencymin;              ///< minimal frequency [Hz]
+  double frequencymax;              ///< maximal frequency [Hz]
+  double mismatch;                  ///< maximum mismatch
+  int nq;                           ///< number of Q-planes
+};
+
 /**
  * Construct and apply a time-frequency-Q analysis.
  * This class was designed to tile the 3-dimensional space in time, frequency and Q. The tiling consists of logarithmically spaced Q-planes. Each of these planes is divided in logarithmically spaced frequency bands. Each of these bands are then linearly divided in time bins. Once constructed, the planes can be used to apply a Q-transform data segments.
@@ -69,6 +90,10 @@ class Otile: public GwollumPlot {
    * @param aMaximumMismatch maximum mismatch between tiles
    * @param aPlotStyle plotting style
    * @param aVerbosity verbosity level
+   * @param aFftPlan FFTW plan used for the frequency band ffts: "FFTW_ESTIMATE", "FFTW_MEASURE", "FFTW_PATIENT" or "FFTW_EXHAUSTIVE"
+   * @param aPrecision floating-point precision used to project the data: "double", "single" or "validate". With "validate", the data are projected in both precisions: the double-precision results are used and the maximum SNR deviation is reported, see GetSNRDeviation().
+   * @param aTilingCache directory where the tiling is cached, "none" for no cache. If a cache file matching the tiling parameters exists in this directory, the Q-plane windows are mapped from this file instead of being computed. Otherwise, the cache file is created.
+   * @param aSparseProjection set to true to allow the input-pruned (sparse) fft for the frequency bands with a short window. The tile SNRs can differ from the full fft by rounding errors: the relative SNR deviation is below 1e-9 in double precision.
    */
   Otile(const int aTimeRange, 
 	const double aQMin, 
@@ -78,7 +103,11 @@ class Otile: public GwollumPlot {
 	const int aSampleFrequency, 
 	const double aMaximumMismatch, 
 	const string aPlotStyle="GWOLLUM", 
-	const int aVerbosity=0);
+	const int aVerbosity=0,
+	const string aFftPlan="FFTW_ESTIMATE",
+	const string aPrecision="double",
+	const string aTilingCache="none",
+	const bool aSparseProjection=false);
 
   /**
    * Destructor of the Otile class.
@@ -104,6 +133,27 @@ class Otile: public GwollumPlot {
     return qplanes[aQindex]->GetQ();
   };
 
+  /**
+   * Returns the number of frequency bands of a given plane.
+   * @param aQindex Q-plane index (no check)
+   */
+  inline int GetNBands(const int aQindex){ return qplanes[aQindex]->GetNBands(); };
+
+  /**
+   * Returns the central frequency of a frequency band [Hz].
+   * @param aQindex Q-plane index (no check)
+   * @param aBandIndex frequency band index (no check)
+   */
+  inline double GetBandFrequency(const int aQindex, const int aBandIndex){ return qplanes[aQindex]->GetBandFrequency(aBandIndex); };
+
+  /**
+   * Returns the noise amplitude of a frequency band.
+   * See SetPower().
+   * @param aQindex Q-plane index (no check)
+   * @param aBandIndex frequency band index (no check)
+   */
+  inline double GetBandNoiseAmplitude(const int aQindex, const int aBandIndex){ return qplanes[aQindex]->bandNoiseAmplitude[aBandIndex]; };
+
   /**
    * Displays a canonical representation of a given Q-plane.
    * @param aQindex Q-plane index
@@ -118,25 +168,107 @@ class Otile: public GwollumPlot {
    * Two spectra must be given as a double whitening is into play.
    *
    * The PSDs must be given as valid Spectrum structures, i.e, the PSDs were previously computed.
+   *
+   * The noise powers are sampled once on the frequency bins (1/time range) and the band noise amplitudes are obtained with scalar products against the squared windows. Between the frequency bins, the noise powers are linearly interpolated, as in the Spectrum class: when the PSD frequencies fall on the frequency bins (even time range), the result is the same as a direct evaluation of the PSDs at the window frequencies. The frequency bins where the inverse noise amplitude changed by less than a relative tolerance since the last update are not updated and the bands where no frequency bin was updated are not computed again, see SetPowerTolerance().
    * @param aSpec1 Spectrum structure where the PSD has been computed (1st)
    * @param aSpec2 Spectrum structure where the PSD has been computed (2nd)
    */
   bool SetPower(Spectrum *aSpec1, Spectrum *aSpec2);
 
+  /**
+   * Sets the relative tolerance to update the noise power.
+   * When calling SetPower(), the noise amplitude is only computed again for the frequency bands where the inverse noise amplitude changed by more than this relative tolerance. The relative error on the band noise amplitudes is therefore bounded by this tolerance. With a null tolerance (default), the bands are updated as soon as the power changes.
+   * @param aTolerance relative tolerance
+   */
+  inline void SetPowerTolerance(const double aTolerance){ PowerTolerance=TMath::Max(0.0, aTolerance); };
+
   /**
    * Projects a data vector onto the Q planes.
    * The complex data vector is projected onto all the Q-planes.
    * The data are provided through a fft object. The fft:Forward() must be done before calling this function.
    * The number of tiles (excluding overlaps/2) above the SNR threshold is returned.
+   * The tiles above the SNR threshold are listed in the same pass: they are used by SaveTriggers() which does not need to scan the Q-planes again.
    *
    * IMPORTANT: the input data vector must the right size, i.e. SampleFrequency/2 as defined in the constructor. No check will be performed!
    * @param aDataFft fft structure containing the data to project
    */
   int ProjectData(fft *aDataFft);
 
+  /**
+   * Sets the number of threads to project the data.
+   * By default, the data are projected with a single thread. With multiple threads, the projection is performed in parallel: the work items are the batches of frequency bands of all the Q-planes. They are distributed across a pool of threads with work-stealing, starting with the largest bands. The results are identical to the single-thread projection.
+   * @param aNthreads number of threads. If 0 (or negative), the number of threads is given by the number of available cores.
+   */
+  void SetNThreads(const int aNthreads=1);
+
+  /**
+   * Returns the number of threads used to project the data.
+   */
+  int GetNThreads(void);
+
+  /**
+   * Sets the time window where the data are projected.
+   * By default, all the tiles are computed by ProjectData(). With this function, only the tiles overlapping the time window are computed and scanned: the other tiles are ignored by SaveTriggers() and must not be used by SaveMaps(). When the time window is small enough, the band ffts are pruned to compute only the requested tiles.
+   * @param aTimeStart window start time, relative to the chunk center [s]
+   * @param aTimeEnd window end time, relative to the chunk center [s]
+   */
+  inline void SetProjectionWindow(const double aTimeStart, const double aTimeEnd){
+    for(int q=0; q<nq; q++) qplanes[q]->SetProjectionWindow(aTimeStart, aTimeEnd);
+    for(int q=0; q<ncq; q++) cqplanes[q]->SetProjectionWindow(aTimeStart, aTimeEnd);
+  };
+
+  /**
+   * Activates the coarse-to-fine search.
+   * With this option, ProjectData() first projects the data onto a coarse tiling, built with a larger mismatch. The bound applies to the tile energy \f$E=\mathrm{SNR}^2+2\f$: a tile above the SNR threshold has an energy above \f$E_{thr}=\mathrm{SNRThr}^2+2\f$ and it loses at most a fraction `aCoarseMismatch` \f$m\f$ of this energy in the coarse tiling. The coarse energy threshold \f$E_c=(1-m)E_{thr}\f$ is lowered by COARSE_NSIGMA times the standard deviation of the energy in Gaussian noise, \f$2\sqrt{E_c-1}\f$. The Q-planes are then projected only for the band batches close (in Q and frequency) to a coarse tile with a SNR above \f$\sqrt{E_c-2\,\mathrm{COARSE\_NSIGMA}\sqrt{E_c-1}-2}\f$. The other bands are set to 0.
+   *
+   * The tiles above the SNR threshold are the same as with the full search, except for some tiles close to the threshold where the noise can push the coarse tile below the coarse threshold. This loss rate is measured by the `coarse` test. Maps only show the selected bands. The fraction of skipped tiles is given by GetCoarseSkipFraction().
+   * @param aCoarseMismatch mismatch of the coarse tiling. It must be larger than the maximum mismatch. Use 0 to deactivate the coarse search.
+   */
+  bool SetCoarseSearch(const double aCoarseMismatch);
+
+  /**
+   * Skips the frequency bands which cannot contain a tile above the SNR threshold.
+   * With this option, ProjectData() computes an upper bound of the tile energy for each frequency band, before the backward fft. The Q coefficients of a band are a sum over the windowed data samples, so their modulus cannot exceed the sum of the moduli of the windowed data samples. The bands with a bound below the SNR threshold are not scanned, and the band batches where all the bands are below the threshold are not transformed: their tiles are set to 0. The triggers are not affected but the maps only show the bands with a bound above threshold.
+   * @param aEnergyBound set to true to activate the energy bound
+   */
+  inline void SetEnergyBound(const bool aEnergyBound){ energybound=aEnergyBound; };
+
+  /**
+   * Returns the fraction of tiles skipped by the coarse search in the last call to ProjectData().
+   * See SetCoarseSearch().
+   */
+  inline double GetCoarseSkipFraction(void){ return coarseskip; };
+
+  /**
+   * Returns the floating-point precision used to project the data.
+   * "double", "single" or "validate".
+   */
+  inline string GetPrecision(void){ return precision; };
+
+  /**
+   * Returns true if the input-pruned (sparse) fft is allowed to project the data.
+   */
+  inline bool GetSparseProjection(void){ return SparseProjection; };
+
+  /**
+   * Returns the maximum SNR deviation between single and double precision.
+   * The deviation is computed over all the tiles of the last call to ProjectData() (excluding overlaps/2). This is only available with the "validate" precision: 0 is returned otherwise.
+   */
+  inline double GetSNRDeviation(void){ return snrdev; };
+
+  /**
+   * Returns the maximum SNR in a time window.
+   * All the tiles overlapping the time window are scanned, whatever the SNR threshold. The tiles must have been computed with the last call to ProjectData(), see SetProjectionWindow().
+   * @param aTimeStart window start time, relative to the chunk center [s]
+   * @param aTimeEnd window end time, relative to the chunk center [s]
+   * @param aTime returned time of the loudest tile, relative to the chunk center [s]
+   * @param aFrequency returned frequency of the loudest tile [Hz]
+   */
+  double GetSNRMax(const double aTimeStart, const double aTimeEnd, double &aTime, double &aFrequency);
+
   /**
    * Saves tiles in a MakeTriggers structure.
-   * Tiles with a SNR value above the SNR threshold are saved in the input trigger structure.
+   * Tiles with a SNR value above the SNR threshold are saved in the input trigger structure. The tiles are taken from the lists built by the last call to ProjectData(). If the SNR threshold was lowered since then, all the tiles computed by the last call to ProjectData() are scanned: the tiles outside the projection window are never saved, see SetProjectionWindow().
    * The corresponding triggers Segments are also saved following the GWOLLUM convention for triggers. If the Sequence algorithm is in use, the current timing is applied to the tiling.
    *
    * A time selection is performed if specific output segments were previously set with SetSegments(): triggers the time of which is outside the output segment list are not saved.
@@ -183,7 +315,6 @@ class Otile: public GwollumPlot {
     if(!aMapFill.compare("amplitude")) mapfill="amplitude";
     else if(!aMapFill.compare("phase")) mapfill="phase";
     else mapfill="snr";
-    for(int q=0; q<nq; q++) qplanes[q]->GetZaxis()->SetTitle(StringToUpper(mapfill).c_str());
     return;
   };
 
@@ -269,6 +400,21 @@ class Otile: public GwollumPlot {
     SeqOverlap=aOverlapDuration+aOverlapDuration%2;
   };
 
+  /**
+   * Sets the sequence stride (streaming mode).
+   * The chunks are moved forward by `aStride` seconds: the overlap duration is set to the time range minus the stride, see SetOverlapDuration(). In addition, when a new chunk is loaded with NewChunk(), the projection window (see SetProjectionWindow()) is set to the part of the chunk where triggers are saved: the tiles in the overlaps are not computed.
+   *
+   * Use 0 to go back to the standard sequence (the overlap duration is not changed and all the tiles are computed).
+   * @param aStride stride [s]: it must be an even number between 2 and the time range (excluded).
+   */
+  bool SetStride(const int aStride);
+
+  /**
+   * Returns the sequence stride [s].
+   * 0 is returned if the streaming mode is not active, see SetStride().
+   */
+  inline int GetStride(void){ return SeqStride; };
+
   /**
    * Loads a new sequence chunk.
    * The chunks are loaded following the definition presented in the description of this class. This function should be called iteratively to cover the full data set defined with SetSegments(). The returned value indicates the status of this operation:
@@ -278,6 +424,15 @@ class Otile: public GwollumPlot {
    */
   bool NewChunk(bool &aNewSegFlag);
 
+  /**
+   * Returns the time boundaries of the next chunks.
+   * The chunk sequence is not modified: the returned chunks are the ones which will be loaded by the next calls to NewChunk().
+   * @param aN maximum number of chunks
+   * @param aStarts returned GPS starts of the next chunks
+   * @param aEnds returned GPS ends of the next chunks
+   */
+  void GetNextChunks(const int aN, vector <int> &aStarts, vector <int> &aEnds);
+
   /**
    * Returns the GPS center time of current chunk.
    */
@@ -292,6 +447,18 @@ class Otile: public GwollumPlot {
    * Returns the GPS ending time of current chunk.
    */
   inline int GetChunkTimeEnd(void){ return SeqT0+TimeRange/2; };
+
+  /**
+   * Returns the starting time of the current chunk output, relative to the chunk center [s].
+   * Triggers are only saved between GetChunkOutputStart() and GetChunkOutputEnd(): the overlaps are excluded.
+   */
+  inline int GetChunkOutputStart(void){ return -TimeRange/2+SeqOverlapCurrent-SeqOverlap/2; };
+
+  /**
+   * Returns the ending time of the current chunk output, relative to the chunk center [s].
+   * See GetChunkOutputStart().
+   */
+  inline int GetChunkOutputEnd(void){ return TimeRange/2-SeqOverlap/2; };
   
   /**
    * Returns the current overlap duration.
@@ -327,6 +494,13 @@ class Otile: public GwollumPlot {
  private:
 
   int fVerbosity;               ///< verbosity level
+  double QMin;                  ///< minimal Q value
+  double QMax;                  ///< maximal Q value
+  double FrequencyMin;          ///< minimal frequency [Hz]
+  double FrequencyMax;          ///< maximal frequency [Hz]
+  int SampleFrequency;          ///< sampling frequency [Hz]
+  string FftPlan;               ///< fft plan
+  bool SparseProjection;        ///< input-pruned fft allowed
   double MaximumMismatch;       ///< maximum mismatch
   Oqplane **qplanes;            ///< Q planes
   int nq;                       ///< number of q planes
@@ -339,8 +513,40 @@ class Otile: public GwollumPlot {
   TF1 *chirp;                   ///< chirp track
   double mchirp;                ///< chirp mass in solar masses
   double tchirp;                ///< chirp merger GPS time.
+  Opool *pool;                  //!< thread pool
+  vector <int> work_q;          ///< work items: Q-plane index
+  vector <int> work_b;          ///< work items: band batch index
+  int *work_nt;                 ///< work items: number of tiles above threshold
+  int spec_n;                   ///< data spectrum size
+  double *spec_r;               ///< data spectrum: real part
+  double *spec_i;               ///< data spectrum: imaginary part
+  float *spec_rf;               ///< data spectrum: real part (single precision)
+  float *spec_if;               ///< data spectrum: imaginary part (single precision)
+  double *spec_a;               ///< data spectrum: modulus
+  bool energybound;             ///< skip the bands with an energy bound below threshold
+  string precision;             ///< projection precision
+  double snrdev;                ///< maximum SNR deviation single/double precision
+
+  // NOISE POWER
+  double *PowerVect1;           ///< noise power (1st spectrum) / frequency bin
+  double *PowerVect2;           ///< noise power (2nd spectrum) / frequency bin
+  double *PowerWork;            //!< inverse noise amplitude over a band window
+  int *PowerDrift;              ///< cumulative number of updated frequency bins (last SetPower())
+  int PowerSize;                ///< number of frequency bins
+  int PowerMin;                 ///< first frequency bin
+  bool PowerInit;               ///< the noise power was set
+  double PowerTolerance;        ///< relative tolerance to update the noise power
+
+  // COARSE SEARCH
+  double CoarseMismatch;        ///< coarse tiling mismatch (0 = no coarse search)
+  Oqplane **cqplanes;           ///< coarse Q planes
+  int ncq;                      ///< number of coarse Q planes
+  double coarseskip;            ///< fraction of tiles skipped by the coarse search
+  void CoarseSearch(const double *aDataAbs); ///< coarse search: select the batches to project
 
   TH2D* MakeFullMap(const int aTimeRange, const double aTimeOffset); ///< make full map
+  void* MapTilingCache(const string aFileName, const OtileCacheHeader &aHeader, size_t &aMapSize); ///< map tiling cache file
+  bool SaveTilingCache(const string aFileName, const OtileCacheHeader &aHeader); ///< save tiling cache file
   void ApplyOffset(TH2D *aMap, const double aOffset);
 
   // SEQUENCE
@@ -348,8 +554,10 @@ class Otile: public GwollumPlot {
   Segments *SeqInSegments;      ///< input segments (current - request)
   int SeqOverlap;               ///< nominal overlap duration
   int SeqOverlapCurrent;        ///< current overlap duration
+  int SeqStride;                ///< sequence stride (streaming mode), 0 = not active
   int SeqT0;                    ///< current chunk center
   int SeqSeg;                   ///< current segment index
+  bool NextChunk(int &aSeg, int &aT0, int &aOverlapCurrent, bool &aNewSegFlag); ///< move a sequence state to the next chunk
 
   ClassDef(Otile,0)  
 };
@@ -2,6 +2,9 @@
 //  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
 //////////////////////////////////////////////////////////////////////////////
 #include "Oomicron.h"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
 
 ////////////////////////////////////////////////////////////////////////////////////
 void Omicron::PrintASCIIlogo(void){
@@ -48,8 +51,8 @@ void Omicron::PrintStatusInfo(void){
   cout<<"requested livetime      = "<<(int)inSegments->GetLiveTime()<<"s"<<endl;
   cout<<"number of loaded chunks = "<<chunk_ctr<<endl;
 
-  for(int c=0; c<nchannels; c++){
-    cout<<"\n*** "<<triggers[c]->GetName()<<endl;
+  for(int c=0; c<(int)fChannels.size(); c++){
+    cout<<"\n*** "<<fChannels[c]<<endl;
     cout<<"number of calls                = "<<chan_ctr[c]<<endl;
     cout<<"number of data calls           = "<<chan_data_ctr[c]<<endl;
     cout<<"number of conditioning calls   = "<<chan_cond_ctr[c]<<endl;
@@ -141,3 +144,68 @@ vector <string> Omicron::GetChannels(void){
   return chanlist;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Omicron::ImportFftWisdom(void){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // lock the wisdom files (shared)
+  int lockfd = open((fftwisdom+".lock").c_str(), O_RDWR|O_CREAT, 0664);
+  if(lockfd<0){
+    cerr<<"Omicron::ImportFftWisdom: cannot open lock file "<<fftwisdom<<".lock"<<endl;
+    return false;
+  }
+  flock(lockfd, LOCK_SH);
+
+  // import (the files may not exist yet)
+  bool res=true;
+  if(!access(fftwisdom.c_str(), R_OK))
+    res*=fftw_import_wisdom_from_filename(fftwisdom.c_str());
+  if(!access((fftwisdom+".f").c_str(), R_OK))
+    res*=fftwf_import_wisdom_from_filename((fftwisdom+".f").c_str());
+
+  flock(lockfd, LOCK_UN);
+  close(lockfd);
+
+  if(!res) cerr<<"Omicron::ImportFftWisdom: the wisdom file "<<fftwisdom<<" is corrupted"<<endl;
+  else if(fVerbosity>1) cout<<"Omicron::ImportFftWisdom: fftw wisdom imported from "<<fftwisdom<<endl;
+  return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool Omicron::ExportFftWisdom(void){
+////////////////////////////////////////////////////////////////////////////////////
+
+  // lock the wisdom files (exclusive)
+  int lockfd = open((fftwisdom+".lock").c_str(), O_RDWR|O_CREAT, 0664);
+  if(lockfd<0){
+    cerr<<"Omicron::ExportFftWisdom: cannot open lock file "<<fftwisdom<<".lock"<<endl;
+    return false;
+  }
+  flock(lockfd, LOCK_EX);
+
+  // merge with plans saved by other jobs in the meantime
+  if(!access(fftwisdom.c_str(), R_OK))
+    fftw_import_wisdom_from_filename(fftwisdom.c_str());
+  if(!access((fftwisdom+".f").c_str(), R_OK))
+    fftwf_import_wisdom_from_filename((fftwisdom+".f").c_str());
+
+  // write in a temporary file and move it: readers never see a partial file
+  bool res=true;
+  stringstream tmpname;
+  tmpname<<fftwisdom<<".tmp."<<getpid();
+  if(fftw_export_wisdom_to_filename(tmpname.str().c_str()))
+    res*=!rename(tmpname.str().c_str(), fftwisdom.c_str());
+  else res=false;
+  if(fftwf_export_wisdom_to_filename(tmpname.str().c_str()))
+    res*=!rename(tmpname.str().c_str(), (fftwisdom+".f").c_str());
+  else res=false;
+  remove(tmpname.str().c_str());
+
+  flock(lockfd, LOCK_UN);
+  close(lockfd);
+
+  if(!res) cerr<<"Omicron::ExportFftWisdom: cannot save the wisdom in "<<fftwisdom<<endl;
+  else if(fVerbosity>1) cout<<"Omicron::ExportFftWisdom: fftw wisdom saved in "<<fftwisdom<<endl;
+  return res;
+}
@@ -43,6 +43,8 @@ omicron [some input timing] [option file] [segment file]
 #include <stdio.h>
 #include "Oomicron.h"
 #include "Segments.h"
+#include <thread>
+#include <atomic>
 
 using namespace std;
 
@@ -90,6 +92,67 @@ void printhelp(void){
     return;
 }
 
+/**
+ * @brief Process all the chunks and the channels of an Omicron object.
+ * @details In strict mode, the processing stops whenever an error is met and the abort flag is raised. The processing also stops when the abort flag is raised by another thread.
+ * @param aO Omicron object
+ * @param aStrict strict mode
+ * @param aAbort abort flag, shared by all the threads
+ * @returns 0 if the processing is over, the program exit code otherwise.
+ */
+int Process(Omicron *aO, const bool aStrict, atomic<bool> *aAbort){
+  int dsize;
+  double *dvector;
+  int res;
+
+  // loop over chunks
+  while(!(*aAbort)&&aO->NewChunk()){
+      
+    // new channels
+    while(aO->NewChannel()){
+      
+      // get data vector
+      dvector=NULL; dsize=0;
+      if(!aO->LoadDataBuffer(&dvector,&dsize)){
+	if(aStrict){ *aAbort=true; return 3; }
+	else continue;
+      }
+	
+      // condition data vector
+      res=aO->Condition(dsize, dvector);
+      if(res<0){
+	*aAbort=true;
+	return 3;// fatal
+      }
+      if(res>0){
+	if(aStrict){ *aAbort=true; return 4; }
+	else continue;
+      }
+
+      // sine-Gaussian injection campaign
+      if(aO->InjectCampaign()<0){
+	if(aStrict){ *aAbort=true; return 5; }
+	else continue;
+      }
+
+      // project data
+      if(aO->Project()<0){
+	if(aStrict){ *aAbort=true; return 5; }
+	else continue;
+      }
+            
+      // write chunk outputs
+      if(!aO->WriteOutput()){
+	if(aStrict){ *aAbort=true; return 6; }
+	else continue;
+      }
+
+    }
+  }
+
+  return 0;
+}
+
 /**
  * @brief Main program.
  */
@@ -161,11 +224,11 @@ int main (int argc, char* argv[]){
     return -2;
   }
 
-  // init omicron
+  // init omicron (channel group 0)
   Omicron *O;
-  if(start) O = new Omicron(optionfile,start,strict);
-  else if(stop) O = new Omicron(optionfile,start,strict);
-  else O = new Omicron(optionfile,-1,strict);
+  if(start) O = new Omicron(optionfile,start,strict,0);
+  else if(stop) O = new Omicron(optionfile,start,strict,0);
+  else O = new Omicron(optionfile,-1,strict,0);
   
   if(!O->GetStatus()){
     cerr<<"omicron: The Omicron object is corrupted."<<endl;
@@ -175,12 +238,14 @@ int main (int argc, char* argv[]){
   O->PrintMessage("Omicron has been successfully initiated");
 
   // input segments
+  double plotoffset=0.0;
   Segments *insegments;
   if(segmentfile.compare("none")) insegments = new Segments(segmentfile);
   else if(start&&stop) insegments = new Segments(start,stop);
   else if(start){
     insegments = new Segments(start-O->GetChunkDuration()/2, start+O->GetChunkDuration()/2);
-    O->SetPlotTimeOffset((double)sub/1000.0);
+    plotoffset=(double)sub/1000.0;
+    O->SetPlotTimeOffset(plotoffset);
   }
   else{
     cerr<<"omicron: A valid input timing must be provided."<<endl;
@@ -203,75 +268,69 @@ int main (int argc, char* argv[]){
     return -5;
   }
 
+  // one Omicron object per channel group
+  // (each object only builds the channels of its group)
+  int nthreads = O->GetNChannelThreads();
+  Omicron **OG = new Omicron* [nthreads];
+  OG[0]=O;
+  for(int t=1; t<nthreads; t++){
+    if(start||stop) OG[t] = new Omicron(optionfile,start,strict,t);
+    else OG[t] = new Omicron(optionfile,-1,strict,t);
+    if(!OG[t]->GetStatus()){
+      cerr<<"omicron: The Omicron object is corrupted."<<endl;
+      for(int u=0; u<=t; u++) delete OG[u];
+      delete [] OG;
+      delete insegments;
+      delete outsegments;
+      return -3;
+    }
+    OG[t]->SetPlotTimeOffset(plotoffset);
+  }
   
-  // locals
-  int dsize;
-  double *dvector;
-  int res;
-  
-  // init segments
-  if(!O->InitSegments(insegments,outsegments)) return 1;
-  delete insegments;
-  delete outsegments;
+  for(int t=0; t<nthreads; t++){
 
-  // create specific trigger directories
-  if(!stop&&!segmentfile.compare("none")){
-    if(!O->MakeDirectories((double)start+(double)sub/1000.0)) return 2;
-  }
-  else{
-    if(!O->MakeDirectories()) return 2;
+    // init segments
+    if(!OG[t]->InitSegments(insegments,outsegments)) return 1;
+
+    // create specific trigger directories
+    if(!stop&&!segmentfile.compare("none")){
+      if(!OG[t]->MakeDirectories((double)start+(double)sub/1000.0)) return 2;
+    }
+    else{
+      if(!OG[t]->MakeDirectories()) return 2;
+    }
   }
+  delete insegments;
+  delete outsegments;
 
   O->PrintMessage("Start looping over chunks and channels");
 
-  // loop over chunks
-  while(O->NewChunk()){
-      
-    // new channels
-    while(O->NewChannel()){
-      
-      // get data vector
-      dvector=NULL; dsize=0;
-      if(!O->LoadData(&dvector,&dsize)){
-	if(strict){ delete O; return 3; }
-	else continue;
-      }
-	
-      // condition data vector
-      res=O->Condition(dsize, dvector);
-      if(res<0){
-	delete dvector;
-	return 3;// fatal
-      }
-      if(res>0){
-	delete dvector;
-	if(strict){ delete O; return 4; }
-	else continue;
-      }
-      delete dvector;// not needed anymore
-
-      // project data
-      if(O->Project()<0){
-	if(strict){ delete O; return 5; }
-	else continue;
-      }
-            
-      // write chunk outputs
-      if(!O->WriteOutput()){
-	if(strict){ delete O; return 6; }
-	else continue;
-      }
+  // process the channel groups in parallel
+  atomic<bool> abort(false);
+  int *res = new int [nthreads];
+  thread *workers = new thread [nthreads];
+  for(int t=1; t<nthreads; t++) workers[t] = thread([&, t](){ res[t]=Process(OG[t], strict, &abort); });
+  res[0]=Process(O, strict, &abort);
+  for(int t=1; t<nthreads; t++) workers[t].join();
+  delete [] workers;
 
-    }
-  }
-  
   O->PrintMessage("Omicron processing is over");
-  
+
+  // collect the monitoring of all channel groups
+  for(int t=1; t<nthreads; t++) O->MergeChannelGroup(OG[t]);
+
   // prints summary report
   O->PrintStatusInfo();
+
+  // exit code
+  int exitcode=0;
+  for(int t=0; t<nthreads; t++){
+    if(res[t]){ exitcode=res[t]; break; }
+  }
+  delete [] res;
   
-  // cleaning  
-  delete O;
-  return 0;
+  // cleaning (group 0 last: html report)
+  for(int t=nthreads-1; t>=0; t--) delete OG[t];
+  delete [] OG;
+  return exitcode;
 }
-
@@ -0,0 +1,178 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#ifndef __Otest__
+#define __Otest__
+
+#include <TRandom3.h>
+#include <TMath.h>
+#include <Spectrum.h>
+#include <FrameL.h>
+#include <fstream>
+
+using namespace std;
+
+/**
+ * @file
+ * @brief Helper functions shared by the Omicron tests.
+ * @details The test programs return 0 on success and 1 on failure. The data are generated: when frame files are needed, they are written in a temporary directory (see OtestWriteFrames()).
+ */
+
+/**
+ * @brief Fills a vector with Gaussian white noise.
+ * @param[in] aSize vector size
+ * @param[in] aRandom random generator
+ * @param[out] aData data vector
+ * @param[in] aSigma noise standard deviation
+ */
+inline void OtestNoise(const int aSize, TRandom3 *aRandom, double *aData, const double aSigma=1.0){
+  for(int i=0; i<aSize; i++) aData[i]=aRandom->Gaus(0.0, aSigma);
+}
+
+/**
+ * @brief Adds a sine-Gaussian to a vector.
+ * @param[in] aSize vector size
+ * @param[in] aSampleFrequency sampling frequency [Hz]
+ * @param[in,out] aData data vector
+ * @param[in] aTime central time, relative to the vector start [s]
+ * @param[in] aFrequency central frequency [Hz]
+ * @param[in] aQ quality factor
+ * @param[in] aAmplitude peak amplitude
+ */
+inline void OtestSineGaussian(const int aSize, const int aSampleFrequency, double *aData,
+                              const double aTime, const double aFrequency, const double aQ, const double aAmplitude){
+  double tau=aQ/(TMath::Sqrt(2.0)*TMath::Pi()*aFrequency);
+  double t;
+  int istart=TMath::Max(0, (int)((aTime-6.0*tau)*(double)aSampleFrequency));
+  int iend=TMath::Min(aSize, (int)((aTime+6.0*tau)*(double)aSampleFrequency)+1);
+  for(int i=istart; i<iend; i++){
+    t=(double)i/(double)aSampleFrequency-aTime;
+    aData[i]+=aAmplitude*exp(-t*t/tau/tau)*sin(2.0*TMath::Pi()*aFrequency*t);
+  }
+}
+
+/**
+ * @brief Returns the amplitude of a sine-Gaussian with a given SNR in unit-variance white noise.
+ * @details The optimal SNR is \f$\sqrt{f_s\int h^2(t)dt}\f$.
+ * @param[in] aSampleFrequency sampling frequency [Hz]
+ * @param[in] aFrequency central frequency [Hz]
+ * @param[in] aQ quality factor
+ * @param[in] aSNR optimal SNR
+ */
+inline double OtestSineGaussianAmplitude(const int aSampleFrequency, const double aFrequency, const double aQ, const double aSNR){
+  double tau=aQ/(TMath::Sqrt(2.0)*TMath::Pi()*aFrequency);
+  return aSNR*sqrt(2.0/((double)aSampleFrequency*tau*sqrt(TMath::Pi()/2.0)));
+}
+
+/**
+ * @brief Transforms unit-variance white noise data to the frequency domain, whitened as in Omicron::Condition().
+ * @details For unit-variance white noise, the 2 whitening steps and the fft normalizations reduce to a scaling by \f$1/\sqrt{f_s}\f$. The DC component is removed.
+ * @param[in] aFft fft object (r2c)
+ * @param[in] aData time-domain data vector
+ * @param[in] aSampleFrequency sampling frequency [Hz]
+ * @returns false if the fft failed
+ */
+inline bool OtestWhiteFft(fft *aFft, double *aData, const int aSampleFrequency){
+  if(!aFft->Forward(aData)) return false;
+  double norm=1.0/sqrt((double)aSampleFrequency);
+  aFft->SetRe_f(0, 0.0);
+  aFft->SetIm_f(0, 0.0);
+  for(int i=1; i<aFft->GetSize_f(); i++){
+    aFft->SetRe_f(i, aFft->GetRe_f(i)*norm);
+    aFft->SetIm_f(i, aFft->GetIm_f(i)*norm);
+  }
+  return true;
+}
+
+/**
+ * @brief Writes frame files with white noise and the corresponding FFL file.
+ * @details The frame files are written in a directory, one file every aFileDuration seconds. Each channel is filled with unit-variance white noise (double precision). The FFL file lists the frame files with the format: path, GPS start, duration, 0, 0.
+ * @param[in] aDirectory output directory
+ * @param[in] aChannels list of channel names
+ * @param[in] aSampleFrequency sampling frequency [Hz]
+ * @param[in] aGpsStart GPS start time [s]
+ * @param[in] aDuration total duration [s]
+ * @param[in] aFileDuration duration of one frame file [s]
+ * @param[in] aRandom random generator
+ * @returns the path to the FFL file, or an empty string if the frames cannot be written
+ */
+inline string OtestWriteFrames(const string aDirectory, const vector <string> aChannels, const int aSampleFrequency,
+                               const int aGpsStart, const int aDuration, const int aFileDuration, TRandom3 *aRandom){
+  string fflfile=aDirectory+"/frames.ffl";
+  ofstream ffl(fflfile.c_str());
+  if(!ffl.is_open()) return "";
+  FrameH *frame;
+  FrAdcData *adc;
+  FrFile *ofile;
+  for(int gps=aGpsStart; gps<aGpsStart+aDuration; gps+=aFileDuration){
+    string framefile=aDirectory+"/X-TEST-"+to_string(gps)+"-"+to_string(aFileDuration)+".gwf";
+    frame = FrameHNew((char*)"TEST");
+    frame->GTimeS=gps;
+    frame->GTimeN=0;
+    frame->dt=(double)aFileDuration;
+    for(int c=0; c<(int)aChannels.size(); c++){
+      adc = FrAdcDataNew(frame, (char*)aChannels[c].c_str(), (double)aSampleFrequency, (long)(aFileDuration*aSampleFrequency), -64);
+      if(adc==NULL){
+        FrameFree(frame);
+        return "";
+      }
+      OtestNoise(aFileDuration*aSampleFrequency, aRandom, adc->data->dataD);
+    }
+    ofile = FrFileONew((char*)framefile.c_str(), 0);
+    if(ofile==NULL){
+      FrameFree(frame);
+      return "";
+    }
+    FrameWrite(frame, ofile);
+    FrFileOEnd(ofile);
+    FrameFree(frame);
+    ffl<<framefile<<" "<<gps<<" "<<aFileDuration<<" 0 0"<<endl;
+  }
+  ffl.close();
+  return fflfile;
+}
+
+/**
+ * @brief Writes an Omicron option file.
+ * @details The option file reads the data from an FFL file. The output is written in the directory of the option file. Additional options can be given, one per line (for example "DATA RAWCACHE 1").
+ * @param[in] aOptionFile path to the option file
+ * @param[in] aFflFile path to the FFL file
+ * @param[in] aChannels list of channel names
+ * @param[in] aOptions additional options
+ * @returns false if the file cannot be written
+ */
+inline bool OtestWriteOptions(const string aOptionFile, const string aFflFile, const vector <string> aChannels, const vector <string> aOptions){
+  ofstream opt(aOptionFile.c_str());
+  if(!opt.is_open()) return false;
+  opt<<"DATA FFL "<<aFflFile<<endl;
+  for(int c=0; c<(int)aChannels.size(); c++) opt<<"DATA CHANNELS "<<aChannels[c]<<endl;
+  opt<<"DATA SAMPLEFREQUENCY 1024"<<endl;
+  opt<<"PARAMETER TIMING 16 4"<<endl;
+  opt<<"PARAMETER FREQUENCYRANGE 32 400"<<endl;
+  opt<<"PARAMETER QRANGE 4 64"<<endl;
+  opt<<"PARAMETER MISMATCHMAX 0.3"<<endl;
+  opt<<"PARAMETER SNRTHRESHOLD 5"<<endl;
+  opt<<"PARAMETER PSDLENGTH 32"<<endl;
+  opt<<"PARAMETER FFTPLAN FFTW_ESTIMATE"<<endl;
+  opt<<"OUTPUT DIRECTORY "<<aOptionFile.substr(0, aOptionFile.rfind('/'))<<endl;
+  opt<<"OUTPUT PRODUCTS triggers"<<endl;
+  opt<<"OUTPUT FORMAT root"<<endl;
+  opt<<"OUTPUT VERBOSITY 0"<<endl;
+  for(int o=0; o<(int)aOptions.size(); o++) opt<<aOptions[o]<<endl;
+  opt.close();
+  return true;
+}
+
+/**
+ * @brief Checks a test condition.
+ * @details A message is printed if the condition is not met.
+ * @param[in] aCondition test condition
+ * @param[in] aMessage message to print if the condition is not met
+ * @returns aCondition
+ */
+inline bool OtestCheck(const bool aCondition, const string aMessage){
+  if(!aCondition) cerr<<"FAILED: "<<aMessage<<endl;
+  return aCondition;
+}
+
+#endif
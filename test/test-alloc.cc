@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Oomicron.h"
+#include <fftw3.h>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/**
+ * @file
+ * @brief Test: no buffer allocation after the first chunk.
+ * @details Frame files are generated for 2 channels and the full chunk loop is run: NewChunk(), NewChannel(), Omicron::LoadDataBuffer() and Omicron::LoadData() in a user vector, Condition(), Project() and WriteOutput(). The C++ allocations (operator new) and the FFTW allocations larger than 4 kB are counted for each step, after the first chunk. The test is run with the default reading, with the @ref omicron_readoptions_data_batchread "batch reading", and with the batch reading and the @ref omicron_readoptions_data_rawcache "raw data cache". The expectations are:
+ * - the chunk and channel iterations, Condition() and Project() do not allocate,
+ * - with the batch reading, loading the data does not allocate,
+ * - with the default reading, each read allocates exactly one vector: the frame reader (ffl::GetData()) returns a new vector which is copied into the Omicron buffer and deleted,
+ * - WriteOutput() writes a new ROOT trigger file for each chunk and channel: ROOT allocates the file, tree and compression buffers. This number does not depend on the data size; it must not exceed OTEST_ALLOC_WRITE_MAX per call.
+ *
+ * The frame reading library (C allocations) is not monitored.
+ */
+
+// minimum allocation size to count [bytes]
+#define OTEST_ALLOC_MIN 4096
+
+// maximum number of allocations per WriteOutput() call (ROOT output file)
+#define OTEST_ALLOC_WRITE_MAX 1000
+
+// steps of the chunk loop
+enum OtestStep { step_none=-1, step_chunk, step_load, step_condition, step_project, step_write, step_n };
+static const string step_name[step_n]={"chunk/channel", "load", "condition", "project", "write"};
+static int alloc_step=step_none;
+static long int alloc_n[step_n];
+
+// allocation counter
+static void* OtestAlloc(const size_t aSize){
+  if(alloc_step!=step_none&&aSize>=OTEST_ALLOC_MIN) alloc_n[alloc_step]++;
+  void *ptr=NULL;
+  if(posix_memalign(&ptr, 64, aSize>0?aSize:1)) throw bad_alloc();
+  return ptr;
+}
+
+void* operator new(size_t aSize){ return OtestAlloc(aSize); }
+void* operator new[](size_t aSize){ return OtestAlloc(aSize); }
+void operator delete(void *aPtr) noexcept { free(aPtr); }
+void operator delete[](void *aPtr) noexcept { free(aPtr); }
+void operator delete(void *aPtr, size_t) noexcept { free(aPtr); }
+void operator delete[](void *aPtr, size_t) noexcept { free(aPtr); }
+void* fftw_malloc(size_t aSize){ return OtestAlloc(aSize); }
+void fftw_free(void *aPtr){ free(aPtr); }
+
+int main(void){
+
+  const int gps=1000000000;
+  const int duration=96;
+  bool ok=true;
+
+  // frame files
+  char tmpdir[]="/tmp/omicron-test-alloc.XXXXXX";
+  if(mkdtemp(tmpdir)==NULL){
+    cerr<<"FAILED: cannot create a temporary directory"<<endl;
+    return 1;
+  }
+  vector <string> channels;
+  channels.push_back("X1:TEST-A");
+  channels.push_back("X1:TEST-B");
+  TRandom3 *rnd = new TRandom3(17);
+  string fflfile=OtestWriteFrames(tmpdir, channels, 2048, gps, duration, 8, rnd);
+  ok&=OtestCheck(fflfile.compare(""), "the frame files cannot be written");
+
+  // 0: default reading, 1: batch reading, 2: batch reading + raw data cache
+  const int ncases=3;
+  vector <string> options[ncases];
+  options[1].push_back("DATA BATCHREAD 1");
+  options[2].push_back("DATA BATCHREAD 1");
+  options[2].push_back("DATA RAWCACHE 1");
+
+  const int capacity=16*2048;
+  double *uservect = new double [capacity];
+  double *dvector;
+  int dsize, usize;
+  for(int o=0; o<ncases&&ok; o++){
+    string optfile=(string)tmpdir+"/options.txt";
+    ok&=OtestCheck(OtestWriteOptions(optfile, fflfile, channels, options[o]), "the option file cannot be written");
+    Omicron *omi = new Omicron(optfile);
+    ok&=OtestCheck(omi->GetStatus()&&omi->GetNChannels()==2, "the Omicron object cannot be created (case "+to_string(o)+")");
+    Segments *seg = new Segments(gps, gps+duration);
+    ok&=OtestCheck(ok&&omi->InitSegments(seg), "the segments cannot be initialized (case "+to_string(o)+")");
+
+    // only count after the first chunk
+    int nchunks=0, nreads=0, nwrites=0;
+    for(int s=0; s<step_n; s++) alloc_n[s]=0;
+    while(ok){
+      alloc_step=(nchunks>0)?step_chunk:step_none;
+      if(!omi->NewChunk()) break;
+      while(ok){
+        alloc_step=(nchunks>0)?step_chunk:step_none;
+        if(!omi->NewChannel()) break;
+
+        // load: internal buffer and user vector (2 reads)
+        alloc_step=(nchunks>0)?step_load:step_none;
+        ok&=OtestCheck(omi->LoadDataBuffer(&dvector, &dsize), "the data cannot be loaded in the internal buffer");
+        ok&=OtestCheck(omi->LoadData(uservect, capacity, &usize), "the data cannot be loaded in the user vector");
+        if(nchunks>0) nreads+=2;
+        alloc_step=step_none;
+        ok&=OtestCheck(dsize==usize&&!memcmp(dvector, uservect, dsize*sizeof(double)), "the user vector does not match the internal buffer");
+
+        // processing
+        alloc_step=(nchunks>0)?step_condition:step_none;
+        ok&=OtestCheck(ok&&!omi->Condition(dsize, dvector), "the data cannot be conditioned");
+        alloc_step=(nchunks>0)?step_project:step_none;
+        ok&=OtestCheck(ok&&omi->Project()>=0, "the data cannot be projected");
+        alloc_step=(nchunks>0)?step_write:step_none;
+        ok&=OtestCheck(ok&&omi->WriteOutput(), "the output cannot be written");
+        if(nchunks>0) nwrites++;
+        alloc_step=step_none;
+      }
+      nchunks++;
+    }
+    alloc_step=step_none;
+
+    cout<<"test-alloc: case "<<o<<": allocations after the first chunk ("<<nchunks<<" chunks, "<<nreads<<" reads, "<<nwrites<<" writes):";
+    for(int s=0; s<step_n; s++) cout<<" "<<step_name[s]<<" = "<<alloc_n[s];
+    cout<<endl;
+    ok&=OtestCheck(nchunks>2, "not enough chunks (case "+to_string(o)+")");
+    ok&=OtestCheck(alloc_n[step_chunk]==0, "the chunk/channel iterations allocate after the first chunk (case "+to_string(o)+")");
+    if(o==0) ok&=OtestCheck(alloc_n[step_load]==nreads, "the data reading must allocate one vector per read (case "+to_string(o)+")");
+    else     ok&=OtestCheck(alloc_n[step_load]==0, "the data buffers are allocated after the first chunk (case "+to_string(o)+")");
+    ok&=OtestCheck(alloc_n[step_condition]==0, "the conditioning allocates after the first chunk (case "+to_string(o)+")");
+    ok&=OtestCheck(alloc_n[step_project]==0, "the projection allocates after the first chunk (case "+to_string(o)+")");
+    ok&=OtestCheck(alloc_n[step_write]<=(long int)nwrites*OTEST_ALLOC_WRITE_MAX, "the output writing allocates too much (case "+to_string(o)+")");
+
+    delete seg;
+    delete omi;
+  }
+
+  delete [] uservect;
+  delete rnd;
+  system(("rm -rf "+(string)tmpdir).c_str());
+  return ok?0:1;
+}
@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Oomicron.h"
+#include <Streams.h>
+#include <algorithm>
+#include <sstream>
+
+/**
+ * @file
+ * @brief Test: sine-Gaussian injection campaign.
+ * @details Frame files are generated for 1 channel (white noise). A @ref omicron_readoptions_injection_sgcampaign "sine-Gaussian injection campaign" is run on every chunk with loud injections (true SNR between ~20 and ~70). The campaign output table is read back and the recovered SNR (loudest tile around the injection) is compared to the true SNR (see Oinject::GetTrueSNR()):
+ * - all the injections must be listed in the table,
+ * - the median of the recovered/true SNR ratio must be between 0.85 and 1.1 (the tiling mismatch reduces the recovered SNR),
+ * - the ratio must be between 0.6 and 1.4 for every injection.
+ */
+int main(void){
+
+  const int gps=1000000000;
+  const int duration=64;
+  const int ninj=40;
+  bool ok=true;
+
+  // frame files
+  char tmpdir[]="/tmp/omicron-test-campaign.XXXXXX";
+  if(mkdtemp(tmpdir)==NULL){
+    cerr<<"FAILED: cannot create a temporary directory"<<endl;
+    return 1;
+  }
+  vector <string> channels;
+  channels.push_back("X1:TEST-A");
+  TRandom3 *rnd = new TRandom3(31);
+  string fflfile=OtestWriteFrames(tmpdir, channels, 2048, gps, duration, 16, rnd);
+  ok&=OtestCheck(fflfile.compare(""), "the frame files cannot be written");
+
+  // campaign: the true SNR is ~45 x amplitude (unit-variance white noise sampled at 2048 Hz)
+  vector <string> options;
+  options.push_back("INJECTION SGCAMPAIGN "+to_string(ninj));
+  options.push_back("INJECTION SGTIME -4 4");
+  options.push_back("INJECTION SGFREQUENCY 60 200");
+  options.push_back("INJECTION SGQ 8 40");
+  options.push_back("INJECTION SGAMPLITUDE 0.5 1.5");
+  string optfile=(string)tmpdir+"/options.txt";
+  ok&=OtestCheck(OtestWriteOptions(optfile, fflfile, channels, options), "the option file cannot be written");
+
+  Omicron *omi = new Omicron(optfile);
+  Segments *seg = new Segments(gps, gps+duration);
+  ok&=OtestCheck(omi->GetStatus()&&omi->InitSegments(seg), "the Omicron object cannot be initialized");
+
+  // run the campaign on every chunk
+  double *dvector;
+  int dsize, nchunks=0;
+  while(ok&&omi->NewChunk()){
+    while(ok&&omi->NewChannel()){
+      ok&=OtestCheck(omi->LoadDataBuffer(&dvector, &dsize)&&!omi->Condition(dsize, dvector), "the data cannot be conditioned (chunk "+to_string(nchunks)+")");
+      ok&=OtestCheck(ok&&omi->InjectCampaign()==ninj, "the injection campaign failed (chunk "+to_string(nchunks)+")");
+    }
+    nchunks++;
+  }
+  delete omi;
+
+  // read the campaign table
+  Streams *stream = new Streams(channels[0]);
+  ifstream campfile(((string)tmpdir+"/"+stream->GetNameConv()+"_OMICRONSGCAMPAIGN.txt").c_str());
+  delete stream;
+  ok&=OtestCheck(campfile.is_open(), "the campaign table cannot be opened");
+  vector <double> ratio;
+  string line;
+  double col[9];
+  while(ok&&getline(campfile, line)){
+    if(!line.compare(0, 1, "#")) continue;
+    istringstream ss(line);
+    for(int c=0; c<9; c++) ss>>col[c];
+    ok&=OtestCheck(!ss.fail()&&col[5]>0.0, "the campaign table is corrupted: "+line);
+    if(ok) ratio.push_back(col[6]/col[5]);
+  }
+  campfile.close();
+  ok&=OtestCheck((int)ratio.size()==nchunks*ninj, "the number of injections is incorrect ("+to_string(ratio.size())+")");
+
+  // recovered vs true SNR
+  if(ok&&ratio.size()){
+    double rmin=*min_element(ratio.begin(), ratio.end());
+    double rmax=*max_element(ratio.begin(), ratio.end());
+    sort(ratio.begin(), ratio.end());
+    double median=ratio[ratio.size()/2];
+    cout<<"test-campaign: "<<ratio.size()<<" injections: recovered/true SNR: median = "<<median<<", min = "<<rmin<<", max = "<<rmax<<endl;
+    ok&=OtestCheck(median>=0.85&&median<=1.1, "the recovered SNR does not match the true SNR (median ratio)");
+    ok&=OtestCheck(rmin>=0.6&&rmax<=1.4, "the recovered SNR does not match the true SNR (outliers)");
+  }
+
+  delete seg;
+  delete rnd;
+  system(("rm -rf "+(string)tmpdir).c_str());
+  return ok?0:1;
+}
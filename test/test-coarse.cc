@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Otile.h"
+
+/**
+ * @file
+ * @brief Test: coarse-to-fine search vs full search.
+ * @details Sine-Gaussians with random parameters (SNR between 3 and 12) are added to white noise. The loudest tile around each sine-Gaussian is computed with the full search and with the coarse-to-fine search (see Otile::SetCoarseSearch()).
+ * - If the full search finds a tile above 2 times the SNR threshold, the coarse search must find the same SNR.
+ * - If the full search finds a tile above the SNR threshold, the coarse search must find it in at least 95% of the cases.
+ *
+ * The loss rate close to the threshold is printed.
+ */
+int main(void){
+
+  const int timerange=16;
+  const int sampling=2048;
+  const int n=timerange*sampling;
+  const int nchunks=8;
+  const int ninj=20;
+  const double snrthr=5.5;
+  const double twin=0.05;
+  bool ok=true;
+
+  double *data = new double [n];
+  TRandom3 *rnd = new TRandom3(3);
+  Spectrum *spec = new Spectrum(sampling, timerange, sampling, 0);
+  fft *offt = new fft(n, "FFTW_ESTIMATE", "r2c");
+
+  Otile *full   = new Otile(timerange, 4.0, 64.0, 32.0, 900.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", "double", "none", false);
+  Otile *coarse = new Otile(timerange, 4.0, 64.0, 32.0, 900.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", "double", "none", false);
+  full->SetSNRThr(0.0, snrthr);
+  coarse->SetSNRThr(0.0, snrthr);
+  ok&=OtestCheck(coarse->SetCoarseSearch(0.5), "the coarse search cannot be activated");
+
+  int nabove=0, nlost=0, nloud=0, nloudlost=0;
+  double tinj[ninj], finj, qinj;
+  double snr_f, snr_c, t, f, skip=0.0;
+  for(int c=0; c<nchunks&&ok; c++){
+
+    // white noise + sine-Gaussians (away from the chunk edges)
+    OtestNoise(n, rnd, data);
+    for(int i=0; i<ninj; i++){
+      tinj[i]=2.0+(double)i*(double)(timerange-4)/(double)ninj;
+      finj=exp(rnd->Uniform(log(40.0), log(800.0)));
+      qinj=rnd->Uniform(4.0, 40.0);
+      OtestSineGaussian(n, sampling, data, tinj[i], finj, qinj, OtestSineGaussianAmplitude(sampling, finj, qinj, rnd->Uniform(3.0, 12.0)));
+    }
+    ok&=OtestCheck(spec->AddData(n, data), "the spectrum cannot be computed");
+    ok&=OtestCheck(OtestWhiteFft(offt, data, sampling), "the data cannot be transformed");
+    ok&=OtestCheck(full->SetPower(spec, spec)&&coarse->SetPower(spec, spec), "the tiling power cannot be set");
+    full->ProjectData(offt);
+    coarse->ProjectData(offt);
+    skip+=coarse->GetCoarseSkipFraction()/(double)nchunks;
+
+    // loudest tile around each sine-Gaussian
+    for(int i=0; i<ninj; i++){
+      snr_f=full->GetSNRMax(tinj[i]-(double)timerange/2.0-twin, tinj[i]-(double)timerange/2.0+twin, t, f);
+      snr_c=coarse->GetSNRMax(tinj[i]-(double)timerange/2.0-twin, tinj[i]-(double)timerange/2.0+twin, t, f);
+      if(snr_f<snrthr) continue;
+      nabove++;
+      if(snr_c<snr_f) nlost++;
+      if(snr_f<2.0*snrthr) continue;
+      nloud++;
+      if(snr_c<snr_f) nloudlost++;
+    }
+  }
+
+  cout<<"test-coarse: "<<skip*100.0<<"% of the tiles are skipped"<<endl;
+  cout<<"test-coarse: "<<nlost<<"/"<<nabove<<" loudest tiles above threshold are lost"<<endl;
+  cout<<"test-coarse: "<<nloudlost<<"/"<<nloud<<" loudest tiles above 2 x threshold are lost"<<endl;
+  ok&=OtestCheck(nabove>0&&nloud>0, "no sine-Gaussian above threshold");
+  ok&=OtestCheck(nloudlost==0, "the coarse search misses loud tiles");
+  ok&=OtestCheck((double)nlost<=0.05*(double)nabove, "the coarse search loses more than 5% of the tiles above threshold");
+
+  delete full;
+  delete coarse;
+  delete offt;
+  delete spec;
+  delete rnd;
+  delete [] data;
+  return ok?0:1;
+}
@@ -0,0 +1,67 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Odecimator.h"
+
+/**
+ * @file
+ * @brief Test: frequency response of the polyphase decimator.
+ * @details Sinusoids are decimated with the Odecimator class for several decimation factors. The amplitude of the output is measured away from the edges:
+ * - in the passband (up to 90% of the working Nyquist frequency), the gain must be 1 within 2e-4,
+ * - above the working Nyquist frequency, the aliased output must be attenuated by more than 76 dB (the filter is designed for 80 dB).
+ *
+ * The number of sinusoid cycles is an integer so the mean removal has no effect.
+ */
+
+// returns the amplitude of a decimated sinusoid
+static double OtestAmplitude(Odecimator *aDec, const int aDuration, const double aFrequency, double *aIn, double *aOut){
+  int nin=aDuration*aDec->GetNativeFrequency();
+  int nout=aDuration*aDec->GetWorkingFrequency();
+  for(int i=0; i<nin; i++) aIn[i]=sin(2.0*TMath::Pi()*aFrequency*(double)i/(double)aDec->GetNativeFrequency()+0.3);
+  if(!aDec->Decimate(nin, aIn, aOut)) return -1.0;
+
+  // rms, without the first and last second (edges)
+  double rms=0.0;
+  for(int j=aDec->GetWorkingFrequency(); j<nout-aDec->GetWorkingFrequency(); j++) rms+=aOut[j]*aOut[j];
+  return sqrt(2.0*rms/(double)(nout-2*aDec->GetWorkingFrequency()));
+}
+
+int main(void){
+
+  const int duration=8;
+  const int working=1024;
+  const int factors[3]={2, 4, 16};
+  const double passband[4]={10.0, 100.0, 300.0, 460.0};
+  const double stopband[5]={520.0, 600.0, 1000.0, 3001.0, 7777.0};
+  bool ok=true;
+
+  double *in = new double [duration*working*16];
+  double *out = new double [duration*working];
+  double amp;
+  for(int m=0; m<3&&ok; m++){
+    Odecimator *dec = new Odecimator(factors[m]*working, working);
+    ok&=OtestCheck(dec->GetStatus(), "the decimator cannot be created (M="+to_string(factors[m])+")");
+
+    double pdev=0.0, smax=0.0;
+    for(int f=0; f<4; f++){
+      amp=OtestAmplitude(dec, duration, passband[f], in, out);
+      ok&=OtestCheck(amp>=0.0, "the decimation failed");
+      pdev=TMath::Max(pdev, fabs(amp-1.0));
+    }
+    for(int f=0; f<5; f++){
+      if(stopband[f]>=(double)dec->GetNativeFrequency()/2.0) continue;
+      amp=OtestAmplitude(dec, duration, stopband[f], in, out);
+      ok&=OtestCheck(amp>=0.0, "the decimation failed");
+      smax=TMath::Max(smax, amp);
+    }
+    cout<<"test-decimator: M="<<factors[m]<<": passband deviation = "<<pdev<<", stopband gain = "<<20.0*log10(TMath::Max(smax, 1e-20))<<" dB"<<endl;
+    ok&=OtestCheck(pdev<=2.0e-4, "the passband gain deviates from 1 (M="+to_string(factors[m])+")");
+    ok&=OtestCheck(smax<=1.6e-4, "the aliased frequencies are not attenuated enough (M="+to_string(factors[m])+")");
+    delete dec;
+  }
+
+  delete [] in;
+  delete [] out;
+  return ok?0:1;
+}
@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Oomicron.h"
+
+/**
+ * @file
+ * @brief Test: channel groups.
+ * @details Frame files are generated for 3 channels (white noise) and the channels are dealt to 2 @ref omicron_readoptions_parameter_channelthreads "channel groups". One Omicron object is built per group:
+ * - the group 0 must only build the channels 0 and 2, the group 1 must only build the channel 1,
+ * - NewChannel() must only load the channels of the group,
+ * - a group which does not exist must be rejected,
+ * - the group 1 must be merged into the group 0.
+ */
+int main(void){
+
+  const int gps=1000000000;
+  const int duration=64;
+  bool ok=true;
+
+  // frame files
+  char tmpdir[]="/tmp/omicron-test-groups.XXXXXX";
+  if(mkdtemp(tmpdir)==NULL){
+    cerr<<"FAILED: cannot create a temporary directory"<<endl;
+    return 1;
+  }
+  vector <string> channels;
+  channels.push_back("X1:TEST-A");
+  channels.push_back("X1:TEST-B");
+  channels.push_back("X1:TEST-C");
+  TRandom3 *rnd = new TRandom3(41);
+  string fflfile=OtestWriteFrames(tmpdir, channels, 2048, gps, duration, 16, rnd);
+  ok&=OtestCheck(fflfile.compare(""), "the frame files cannot be written");
+
+  vector <string> options;
+  options.push_back("PARAMETER CHANNELTHREADS 2");
+  string optfile=(string)tmpdir+"/options.txt";
+  ok&=OtestCheck(OtestWriteOptions(optfile, fflfile, channels, options), "the option file cannot be written");
+
+  // one object per group
+  Omicron *omi0 = new Omicron(optfile, -1, false, 0);
+  Omicron *omi1 = new Omicron(optfile, -1, false, 1);
+  ok&=OtestCheck(omi0->GetStatus()&&omi1->GetStatus(), "the Omicron objects cannot be initialized");
+  ok&=OtestCheck(omi0->GetNChannelThreads()==2, "the number of channel groups is incorrect");
+
+  // channels of the groups
+  vector <string> chan0=omi0->GetChannels();
+  vector <string> chan1=omi1->GetChannels();
+  ok&=OtestCheck(omi0->GetNChannels()==2&&chan0.size()==2&&!chan0[0].compare(channels[0])&&!chan0[1].compare(channels[2]), "the channels of the group 0 are incorrect");
+  ok&=OtestCheck(omi1->GetNChannels()==1&&chan1.size()==1&&!chan1[0].compare(channels[1]), "the channels of the group 1 are incorrect");
+
+  // a group which does not exist
+  Omicron *omi2 = new Omicron(optfile, -1, false, 2);
+  ok&=OtestCheck(!omi2->GetStatus(), "the channel group 2 should not exist");
+  delete omi2;
+
+  // load the channels of each group
+  Segments *seg = new Segments(gps, gps+duration);
+  ok&=OtestCheck(omi0->InitSegments(seg)&&omi1->InitSegments(seg), "the segments cannot be initialized");
+  int nloaded=0;
+  if(ok&&omi0->NewChunk()){
+    while(omi0->NewChannel()) nloaded++;
+  }
+  ok&=OtestCheck(nloaded==2, "the group 0 loaded "+to_string(nloaded)+" channels");
+  nloaded=0;
+  if(ok&&omi1->NewChunk()){
+    while(omi1->NewChannel()) nloaded++;
+  }
+  ok&=OtestCheck(nloaded==1, "the group 1 loaded "+to_string(nloaded)+" channels");
+
+  // merge
+  ok&=OtestCheck(omi0->MergeChannelGroup(omi1), "the group 1 cannot be merged");
+
+  delete omi0;
+  delete omi1;
+  delete seg;
+  delete rnd;
+  system(("rm -rf "+(string)tmpdir).c_str());
+  return ok?0:1;
+}
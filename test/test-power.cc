@@ -0,0 +1,100 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Otile.h"
+
+/**
+ * @file
+ * @brief Test: band noise amplitudes.
+ * @details The band noise amplitudes computed by Otile::SetPower() are compared to a direct evaluation: the PSDs are evaluated at every frequency of the bisquare window of every band (eq. 5.28). The noise is colored (red noise + spectral lines) and two different PSDs are used. The chunk duration is even: the PSD frequencies (0.5 Hz resolution) fall on the frequency bins of the tiling.
+ * - Without tolerance, the relative difference must be below 1e-9, after the first call and after a PSD update.
+ * - With a tolerance (see Otile::SetPowerTolerance()), the relative difference must be below the tolerance after a PSD update.
+ */
+
+// direct evaluation of the band noise amplitude
+static double OtestNoiseAmplitude(Spectrum *aSpec1, Spectrum *aSpec2, const int aTimeRange, const double aQ, const double aFrequency){
+  double qprime=aQ/sqrt(11.0);
+  double deltaf=aFrequency/qprime;
+  double wb=sqrt(315.0/128.0*qprime/aFrequency);
+  int n=(int)floor(deltaf*(double)aTimeRange);
+  double freq, win, sum=0.0;
+  for(int i=-n; i<=n; i++){
+    freq=aFrequency+(double)i/(double)aTimeRange;
+    win=wb*(1.0-(freq-aFrequency)*(freq-aFrequency)/deltaf/deltaf)*(1.0-(freq-aFrequency)*(freq-aFrequency)/deltaf/deltaf);
+    sum+=win*win/2.0/sqrt(aSpec1->GetPower(freq)*aSpec2->GetPower(freq)/4.0)/(double)aTimeRange;
+  }
+  return 1.0/sum;
+}
+
+// maximum relative difference with the direct evaluation
+static double OtestDeviation(Otile *aTile, Spectrum *aSpec1, Spectrum *aSpec2){
+  double dev=0.0, amp;
+  for(int q=0; q<aTile->GetNQ(); q++){
+    for(int f=0; f<aTile->GetNBands(q); f++){
+      amp=OtestNoiseAmplitude(aSpec1, aSpec2, aTile->GetTimeRange(), aTile->GetQ(q), aTile->GetBandFrequency(q, f));
+      dev=TMath::Max(dev, fabs(aTile->GetBandNoiseAmplitude(q, f)/amp-1.0));
+    }
+  }
+  return dev;
+}
+
+// colored noise: red noise + white noise + lines
+static void OtestColoredNoise(const int aSize, const int aSampleFrequency, TRandom3 *aRandom, double *aData){
+  double red=0.0;
+  for(int i=0; i<aSize; i++){
+    red=0.999*red+aRandom->Gaus(0.0, 1.0);
+    aData[i]=0.1*red+aRandom->Gaus(0.0, 1.0)
+      +10.0*sin(2.0*TMath::Pi()*60.0*(double)i/(double)aSampleFrequency)
+      +3.0*sin(2.0*TMath::Pi()*331.5*(double)i/(double)aSampleFrequency);
+  }
+}
+
+int main(void){
+
+  const int timerange=16;
+  const int sampling=2048;
+  const int n=timerange*sampling;
+  const double tolerance=0.02;
+  bool ok=true;
+
+  double *data = new double [n];
+  TRandom3 *rnd = new TRandom3(29);
+  Spectrum *spec1 = new Spectrum(sampling, timerange, sampling, 0);
+  Spectrum *spec2 = new Spectrum(sampling, timerange, sampling, 0);
+  OtestColoredNoise(n, sampling, rnd, data);
+  ok&=OtestCheck(spec1->AddData(n, data), "the spectrum cannot be computed");
+  OtestColoredNoise(n, sampling, rnd, data);
+  ok&=OtestCheck(spec2->AddData(n, data), "the spectrum cannot be computed");
+
+  Otile *tile = new Otile(timerange, 4.0, 64.0, 16.0, 900.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", "double", "none", false);
+  Otile *tilet = new Otile(timerange, 4.0, 64.0, 16.0, 900.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", "double", "none", false);
+  tilet->SetPowerTolerance(tolerance);
+
+  // first PSD
+  ok&=OtestCheck(tile->SetPower(spec1, spec2)&&tilet->SetPower(spec1, spec2), "the tiling power cannot be set");
+  double dev=OtestDeviation(tile, spec1, spec2);
+  double devt=OtestDeviation(tilet, spec1, spec2);
+  cout<<"test-power: first PSD: maximum relative deviation = "<<dev<<" (tolerance 0), "<<devt<<" (tolerance "<<tolerance<<")"<<endl;
+  ok&=OtestCheck(dev<=1.0e-9&&devt<=1.0e-9, "the band noise amplitudes differ from the direct evaluation (first PSD)");
+
+  // PSD update
+  OtestColoredNoise(n/2, sampling, rnd, data);
+  ok&=OtestCheck(spec1->AddData(n/2, data), "the spectrum cannot be updated");
+  OtestColoredNoise(n/2, sampling, rnd, data);
+  ok&=OtestCheck(spec2->AddData(n/2, data), "the spectrum cannot be updated");
+  ok&=OtestCheck(tile->SetPower(spec1, spec2)&&tilet->SetPower(spec1, spec2), "the tiling power cannot be set");
+  dev=OtestDeviation(tile, spec1, spec2);
+  devt=OtestDeviation(tilet, spec1, spec2);
+  cout<<"test-power: updated PSD: maximum relative deviation = "<<dev<<" (tolerance 0), "<<devt<<" (tolerance "<<tolerance<<")"<<endl;
+  ok&=OtestCheck(dev<=1.0e-9, "the band noise amplitudes differ from the direct evaluation (updated PSD)");
+  ok&=OtestCheck(devt<=tolerance, "the band noise amplitudes exceed the tolerance (updated PSD)");
+
+  delete tile;
+  delete tilet;
+  delete spec1;
+  delete spec2;
+  delete rnd;
+  delete [] data;
+  return ok?0:1;
+}
@@ -0,0 +1,90 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Oomicron.h"
+#include <cstring>
+#include <sys/stat.h>
+
+/**
+ * @file
+ * @brief Test: raw data cache.
+ * @details Frame files are generated for 2 channels. The data are loaded chunk after chunk with 3 Omicron objects:
+ * - without the @ref omicron_readoptions_data_rawcache "raw data cache",
+ * - with the raw data cache,
+ * - with the raw data cache and the @ref omicron_readoptions_data_batchread "batch reading".
+ *
+ * Each object has its own output directory. The input segments are chosen so that the chunk overlap varies (the last chunk of a segment is moved back to fit in the segment) and so that the chunk sequence crosses segment boundaries (the cache must be reset). The data vectors must be identical for all chunks and all channels.
+ */
+int main(void){
+
+  const int gps=1000000000;
+  const int duration=128;
+  const int nobjects=3;
+  bool ok=true;
+
+  // frame files
+  char tmpdir[]="/tmp/omicron-test-rawcache.XXXXXX";
+  if(mkdtemp(tmpdir)==NULL){
+    cerr<<"FAILED: cannot create a temporary directory"<<endl;
+    return 1;
+  }
+  vector <string> channels;
+  channels.push_back("X1:TEST-A");
+  channels.push_back("X1:TEST-B");
+  TRandom3 *rnd = new TRandom3(23);
+  string fflfile=OtestWriteFrames(tmpdir, channels, 2048, gps, duration, 8, rnd);
+  ok&=OtestCheck(fflfile.compare(""), "the frame files cannot be written");
+
+  // segments: 38 s (the last chunk overlaps by 6 s), 1 s gap, 45 s, 5 s gap, 39 s
+  Segments *seg = new Segments();
+  seg->AddSegment(gps, gps+38);
+  seg->AddSegment(gps+39, gps+84);
+  seg->AddSegment(gps+89, gps+duration);
+
+  // 0: no cache, 1: cache, 2: cache + batch reading
+  vector <string> options[nobjects];
+  options[1].push_back("DATA RAWCACHE 1");
+  options[2].push_back("DATA RAWCACHE 1");
+  options[2].push_back("DATA BATCHREAD 1");
+  Omicron *omi[nobjects];
+  for(int o=0; o<nobjects; o++){
+    string dir=(string)tmpdir+"/o"+to_string(o);
+    ok&=OtestCheck(!mkdir(dir.c_str(), 0755), "cannot create "+dir);
+    string optfile=dir+"/options.txt";
+    ok&=OtestCheck(OtestWriteOptions(optfile, fflfile, channels, options[o]), "the option file cannot be written");
+    omi[o] = new Omicron(optfile);
+    ok&=OtestCheck(omi[o]->GetStatus()&&omi[o]->InitSegments(seg), "the Omicron object cannot be initialized (case "+to_string(o)+")");
+  }
+
+  // load the data with the 3 objects, chunk after chunk
+  double *ref = new double [16*2048];
+  double *dvector;
+  int refsize, dsize, nchunks=0;
+  bool next;
+  while(ok){
+    next=omi[0]->NewChunk();
+    for(int o=1; o<nobjects; o++) ok&=OtestCheck(omi[o]->NewChunk()==next, "the chunk sequence differs (case "+to_string(o)+")");
+    if(!next||!ok) break;
+    nchunks++;
+
+    while(ok&&omi[0]->NewChannel()){
+      for(int o=1; o<nobjects; o++) omi[o]->NewChannel();
+      ok&=OtestCheck(omi[0]->LoadData(ref, 16*2048, &refsize), "the data cannot be loaded (chunk "+to_string(nchunks)+")");
+      for(int o=1; o<nobjects&&ok; o++){
+        ok&=OtestCheck(omi[o]->LoadDataBuffer(&dvector, &dsize), "the data cannot be loaded (case "+to_string(o)+", chunk "+to_string(nchunks)+")");
+        ok&=OtestCheck(ok&&dsize==refsize&&!memcmp(dvector, ref, dsize*sizeof(double)),
+                       "the cached data differ from the data read from the frames (case "+to_string(o)+", chunk "+to_string(nchunks)+", "+omi[o]->GetChannelName()+")");
+      }
+    }
+  }
+  cout<<"test-rawcache: "<<nchunks<<" chunks are compared"<<endl;
+  ok&=OtestCheck(nchunks>=7, "not enough chunks");
+
+  for(int o=0; o<nobjects; o++) delete omi[o];
+  delete [] ref;
+  delete seg;
+  delete rnd;
+  system(("rm -rf "+(string)tmpdir).c_str());
+  return ok?0:1;
+}
@@ -0,0 +1,64 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Otile.h"
+
+/**
+ * @file
+ * @brief Test: input-pruned (sparse) projection vs full projection.
+ * @details The same data are projected with 2 tilings: the first one uses the full fft for all the frequency bands, the second one is allowed to use the input-pruned fft (see Oqengine). The maximum SNR is compared in short time windows covering the chunk. The tolerance is 1e-9 (relative) in double precision and 1e-4 in single precision.
+ */
+int main(void){
+
+  const int timerange=16;
+  const int sampling=2048;
+  const int n=timerange*sampling;
+  const double twin=0.125;
+  bool ok=true;
+
+  // white noise + sine-Gaussians
+  double *data = new double [n];
+  TRandom3 *rnd = new TRandom3(7);
+  OtestNoise(n, rnd, data);
+  OtestSineGaussian(n, sampling, data, 4.0, 40.0, 5.0, 5.0);
+  OtestSineGaussian(n, sampling, data, 8.3, 150.0, 20.0, 3.0);
+  OtestSineGaussian(n, sampling, data, 11.7, 600.0, 8.0, 4.0);
+
+  // noise spectrum
+  Spectrum *spec = new Spectrum(sampling, timerange, sampling, 0);
+  ok&=OtestCheck(spec->AddData(n, data), "the spectrum cannot be computed");
+
+  // data in the frequency domain
+  fft *offt = new fft(n, "FFTW_ESTIMATE", "r2c");
+  ok&=OtestCheck(offt->Forward(data), "the data cannot be transformed");
+
+  string precision[2]={"double", "single"};
+  double tolerance[2]={1.0e-9, 1.0e-4};
+  for(int p=0; p<2&&ok; p++){
+    Otile *dense  = new Otile(timerange, 4.0, 100.0, 16.0, 900.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", precision[p], "none", false);
+    Otile *sparse = new Otile(timerange, 4.0, 100.0, 16.0, 900.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", precision[p], "none", true);
+    ok&=OtestCheck(sparse->GetSparseProjection()&&!dense->GetSparseProjection(), "the sparse projection flag is not set");
+    ok&=OtestCheck(dense->SetPower(spec, spec)&&sparse->SetPower(spec, spec), "the tiling power cannot be set");
+    dense->ProjectData(offt);
+    sparse->ProjectData(offt);
+
+    double snr_d, snr_s, t_d, t_s, f_d, f_s, dev=0.0;
+    for(double t=-(double)timerange/2.0; t<(double)timerange/2.0; t+=twin){
+      snr_d=dense->GetSNRMax(t, t+twin, t_d, f_d);
+      snr_s=sparse->GetSNRMax(t, t+twin, t_s, f_s);
+      dev=TMath::Max(dev, fabs(snr_d-snr_s)/TMath::Max(1.0, snr_d));
+    }
+    cout<<"test-sparse: "<<precision[p]<<" precision: maximum SNR deviation = "<<dev<<endl;
+    ok&=OtestCheck(dev<=tolerance[p], precision[p]+" precision: the sparse projection deviates from the full projection");
+
+    delete dense;
+    delete sparse;
+  }
+
+  delete offt;
+  delete spec;
+  delete rnd;
+  delete [] data;
+  return ok?0:1;
+}
@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Oomicron.h"
+#include <thread>
+#include <algorithm>
+#include <sys/stat.h>
+
+/**
+ * @file
+ * @brief Test: independent Omicron objects in concurrent threads.
+ * @details Frame files are generated for 2 channels. Several Omicron objects are built with different parameters (precision, input-pruned projection, batch reading, raw data cache), each with its own output directory. The objects are built, run and destroyed one after the other, and then concurrently, one thread per object. For every chunk and every channel, the number of tiles above threshold and the number of triggers must be the same in both cases.
+ */
+
+// number of Omicron objects
+#define OTEST_NOBJECTS 6
+
+// builds an Omicron object, processes all the data, records the results and deletes the object
+static void OtestRun(const string aOptionFile, const int aStart, const int aEnd, vector <int> *aResults){
+  aResults->clear();
+  Omicron *omi = new Omicron(aOptionFile);
+  Segments *seg = new Segments(aStart, aEnd);
+  if(!omi->GetStatus()||!omi->InitSegments(seg)){
+    aResults->push_back(-1);
+    delete seg;
+    delete omi;
+    return;
+  }
+  double *dvector;
+  int dsize;
+  while(omi->NewChunk()){
+    while(omi->NewChannel()){
+      if(!omi->LoadDataBuffer(&dvector, &dsize)||omi->Condition(dsize, dvector)){
+        aResults->push_back(-1);
+        continue;
+      }
+      aResults->push_back(omi->Project());
+      aResults->push_back(omi->GetNTriggers());
+      if(!omi->WriteOutput()) aResults->push_back(-1);
+    }
+  }
+  delete seg;
+  delete omi;
+  return;
+}
+
+int main(void){
+
+  const int gps=1000000000;
+  const int duration=64;
+  bool ok=true;
+
+  // frame files
+  char tmpdir[]="/tmp/omicron-test-threads.XXXXXX";
+  if(mkdtemp(tmpdir)==NULL){
+    cerr<<"FAILED: cannot create a temporary directory"<<endl;
+    return 1;
+  }
+  vector <string> channels;
+  channels.push_back("X1:TEST-A");
+  channels.push_back("X1:TEST-B");
+  TRandom3 *rnd = new TRandom3(19);
+  string fflfile=OtestWriteFrames(tmpdir, channels, 2048, gps, duration, 16, rnd);
+  ok&=OtestCheck(fflfile.compare(""), "the frame files cannot be written");
+
+  // option files: one output directory per object
+  string optfile[OTEST_NOBJECTS];
+  for(int o=0; o<OTEST_NOBJECTS&&ok; o++){
+    string dir=(string)tmpdir+"/o"+to_string(o);
+    ok&=OtestCheck(!mkdir(dir.c_str(), 0755), "cannot create "+dir);
+    vector <string> options;
+    options.push_back(o%2?"PARAMETER PRECISION single":"PARAMETER PRECISION double");
+    if(o%3==1) options.push_back("PARAMETER SPARSEPROJECTION 1");
+    if(o%3==2) options.push_back("DATA BATCHREAD 1");
+    if(o>=3) options.push_back("DATA RAWCACHE 1");
+    optfile[o]=dir+"/options.txt";
+    ok&=OtestCheck(OtestWriteOptions(optfile[o], fflfile, channels, options), "the option file cannot be written");
+  }
+
+  // serial run
+  vector <int> serial[OTEST_NOBJECTS];
+  for(int o=0; o<OTEST_NOBJECTS&&ok; o++) OtestRun(optfile[o], gps, gps+duration, &serial[o]);
+
+  // concurrent run
+  vector <int> concurrent[OTEST_NOBJECTS];
+  if(ok){
+    thread *workers = new thread [OTEST_NOBJECTS];
+    for(int o=0; o<OTEST_NOBJECTS; o++) workers[o] = thread(OtestRun, optfile[o], gps, gps+duration, &concurrent[o]);
+    for(int o=0; o<OTEST_NOBJECTS; o++) workers[o].join();
+    delete [] workers;
+  }
+
+  for(int o=0; o<OTEST_NOBJECTS&&ok; o++){
+    int ntiles=0;
+    for(int r=0; r<(int)serial[o].size(); r+=2) ntiles+=serial[o][r];
+    cout<<"test-threads: object "<<o<<": "<<serial[o].size()/2<<" chunks x channels, "<<ntiles<<" tiles above threshold"<<endl;
+    ok&=OtestCheck(serial[o].size()>2&&find(serial[o].begin(), serial[o].end(), -1)==serial[o].end(), "the serial run failed (object "+to_string(o)+")");
+    ok&=OtestCheck(concurrent[o]==serial[o], "the concurrent run differs from the serial run (object "+to_string(o)+")");
+  }
+
+  delete rnd;
+  system(("rm -rf "+(string)tmpdir).c_str());
+  return ok?0:1;
+}
@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Author : florent robinet (LAL - Orsay): robinet@lal.in2p3.fr
+//////////////////////////////////////////////////////////////////////////////
+#include "Otest.h"
+#include "Otile.h"
+#include <dirent.h>
+#include <unistd.h>
+
+/**
+ * @file
+ * @brief Test: tiling cache.
+ * @details A tiling is created without cache, with a new cache file, with the cache file and with a corrupted cache file (the window offsets are not monotonic). The same data are projected and the maximum SNR must be identical in all cases.
+ */
+
+// returns the maximum SNR in short windows
+static vector <double> GetSNRs(Otile *aTile, Spectrum *aSpec, fft *aFft){
+  vector <double> snr;
+  double t, f;
+  aTile->SetPower(aSpec, aSpec);
+  aTile->ProjectData(aFft);
+  for(double ts=-(double)aTile->GetTimeRange()/2.0; ts<(double)aTile->GetTimeRange()/2.0; ts+=0.25)
+    snr.push_back(aTile->GetSNRMax(ts, ts+0.25, t, f));
+  return snr;
+}
+
+int main(void){
+
+  const int timerange=8;
+  const int sampling=1024;
+  const int n=timerange*sampling;
+  bool ok=true;
+
+  // cache directory
+  char cachedir[]="/tmp/omicron-test-tilingcache.XXXXXX";
+  if(mkdtemp(cachedir)==NULL){
+    cerr<<"FAILED: cannot create a temporary directory"<<endl;
+    return 1;
+  }
+
+  // white noise + sine-Gaussian
+  double *data = new double [n];
+  TRandom3 *rnd = new TRandom3(11);
+  OtestNoise(n, rnd, data);
+  OtestSineGaussian(n, sampling, data, 3.0, 80.0, 10.0, 4.0);
+  Spectrum *spec = new Spectrum(sampling, timerange, sampling, 0);
+  ok&=OtestCheck(spec->AddData(n, data), "the spectrum cannot be computed");
+  fft *offt = new fft(n, "FFTW_ESTIMATE", "r2c");
+  ok&=OtestCheck(offt->Forward(data), "the data cannot be transformed");
+
+  // reference: no cache
+  Otile *tile = new Otile(timerange, 4.0, 64.0, 16.0, 400.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", "double", "none", true);
+  vector <double> snr_ref = GetSNRs(tile, spec, offt);
+  delete tile;
+
+  // 0: create the cache, 1: map the cache, 2: corrupted cache
+  string cachefile="";
+  for(int i=0; i<3&&ok; i++){
+    if(i==2){
+      DIR *dir=opendir(cachedir);
+      struct dirent *entry;
+      while(dir!=NULL&&(entry=readdir(dir))!=NULL){
+        if(((string)entry->d_name).find("otile_")==0) cachefile=(string)cachedir+"/"+entry->d_name;
+      }
+      if(dir!=NULL) closedir(dir);
+      ok&=OtestCheck(cachefile.compare(""), "the tiling cache file was not created");
+      if(!ok) break;
+
+      // the offset of the second Q-plane is moved beyond the file
+      fstream cache(cachefile.c_str(), ios::in|ios::out|ios::binary);
+      long int offset=1L<<40;
+      cache.seekp(sizeof(OtileCacheHeader)+sizeof(long int));
+      cache.write((const char*)&offset, sizeof(long int));
+      cache.close();
+    }
+    tile = new Otile(timerange, 4.0, 64.0, 16.0, 400.0, sampling, 0.2, "GWOLLUM", 0, "FFTW_ESTIMATE", "double", cachedir, true);
+    vector <double> snr = GetSNRs(tile, spec, offt);
+    delete tile;
+    ok&=OtestCheck(snr==snr_ref, "the SNRs differ from the tiling without cache (case "+to_string(i)+")");
+  }
+
+  if(cachefile.compare("")) remove(cachefile.c_str());
+  rmdir(cachedir);
+  delete offt;
+  delete spec;
+  delete rnd;
+  delete [] data;
+  return ok?0:1;
+}